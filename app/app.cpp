@@ -1,6 +1,11 @@
 #include "application.h"
 #include "appTheme.h"
+#include "imageDecoder.h"
+#include "fileReader.h"
+#include "entityRegistry.h"
 #include <imgui.h>
+#include <print>
+#include <string_view>
 
 class MainScene : public vica::Scene {
 public:
@@ -15,13 +20,69 @@ public:
     }
 };
 
-int main() {
-    vica::Application app("Co Clock", 900, 600, ApplicationFlag_CustomTitleBar);
+// --record <trace>     record input to a trace file
+// --replay <trace>     replay a recorded trace with a fixed timestep
+// --offscreen          hidden window without vsync; exits when the replay ends
+// --low-latency        at most one frame in flight, input polled just before the UI build
+// --renderer <name>    ImGui renderer, "vica" (default) or "stock"; with --replay the
+//                      summary adds per-frame CPU/GPU render times for the backend
+// --bench-decoders     print image decoder throughput for every file in res/ and exit
+// --bench-io <dir>     time cold/warm batched reads of <dir>, generating it if missing, and exit
+// --bench-entities     compare sparse-set entity storage against a map of objects and exit
+// --bench-uuid         print UUID generation throughput per thread count, check for duplicates and exit
+int main(int argc, char** argv) {
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    ApplicationFlag flags = ApplicationFlag_CustomTitleBar;
+    std::string_view renderer;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--record" && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (arg == "--offscreen")
+            flags |= ApplicationFlag_Offscreen;
+        else if (arg == "--low-latency")
+            flags |= ApplicationFlag_LowLatency;
+        else if (arg == "--renderer" && i + 1 < argc)
+            renderer = argv[++i];
+        else if (arg == "--bench-decoders") {
+            vica::ImageDecoder::Benchmark("res");
+            return 0;
+        }
+        else if (arg == "--bench-io" && i + 1 < argc) {
+            vica::FileReader::Benchmark(argv[++i]);
+            return 0;
+        }
+        else if (arg == "--bench-entities") {
+            vica::EntityRegistry::Benchmark();
+            return 0;
+        }
+        else if (arg == "--bench-uuid") {
+            return vica::UUID::Benchmark() ? 0 : 1;
+        }
+    }
+
+    vica::Application app("Co Clock", 900, 600, flags);
     setAppTheme();
 
+    if (renderer == "stock")
+        app.getSpecs().rendererBackend = vica::ImGuiRendererBackend::Stock;
+    else if (renderer == "vica")
+        app.getSpecs().rendererBackend = vica::ImGuiRendererBackend::Vica;
+    else if (!renderer.empty())
+        std::println("Unknown renderer '{}', using the default.", renderer);
+
     auto& scenes = app.getScenes();
     scenes.add(CreateRef<MainScene>());
-    
+
+    if (replayPath)
+        app.getInputRecorder().startReplay(replayPath);
+    else if (recordPath)
+        app.getInputRecorder().startRecording(recordPath);
+
     app.run();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "animatedImage.h"
+
+#include <algorithm>
+#include <optional>
+#include <print>
+#include <utility>
+
+#include <glad/glad.h>
+#include <imgui.h>
+
+#include "application.h"
+#include "gifStream.h"
+#include "fileReader.h"
+#include "debug/profiler.h"
+
+namespace vica {
+
+    namespace {
+        float getDelaySeconds(uint32_t milliseconds) {
+            // Browsers play GIF delays of 10 ms or less at 100 ms.
+            return (milliseconds <= 10 ? 100 : milliseconds) / 1000.0f;
+        }
+    }
+
+    AnimatedImage::AnimatedImage(const std::filesystem::path& path, uint32_t ringSize)
+        : AnimatedImage(path, readFileBytes(path), ringSize) {
+    }
+
+    AnimatedImage::AnimatedImage(const std::filesystem::path& path, std::vector<uint8_t> file, uint32_t ringSize)
+        : m_Name(path.filename().string()), m_Decoder(CreateRef<Decoder>()) {
+        m_Decoder->stream = CreateScope<GifStream>(std::move(file));
+        if (!m_Decoder->stream->isValid()) {
+            std::println("Failed to load animated image {}", path.string());
+            return;
+        }
+
+        m_Width = m_Decoder->stream->getWidth();
+        m_Height = m_Decoder->stream->getHeight();
+
+        m_Decoder->ring.resize(std::max(ringSize, 2u));
+        for (Frame& frame : m_Decoder->ring)
+            frame.pixels.resize((size_t)m_Width * m_Height * 4);
+
+        m_ImageID = Application::Get().getTexturePool().acquire(getTextureDesc());
+        glTextureParameteri(m_ImageID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(m_ImageID, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(m_ImageID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(m_ImageID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glClearTexImage(m_ImageID, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        requestDecode();
+    }
+
+    AnimatedImage::~AnimatedImage() {
+        m_Decoder->cancelled = true;
+        if (m_ImageID)
+            Application::Get().getTexturePool().release(m_ImageID, getTextureDesc());
+    }
+
+    TextureDesc AnimatedImage::getTextureDesc() const {
+        return { m_Width, m_Height, GL_RGBA8, 1 };
+    }
+
+    void AnimatedImage::Decoder::fill() {
+        VICA_PROFILE_FUNCTION();
+        while (!cancelled.load(std::memory_order_relaxed)) {
+            uint64_t write = written.load(std::memory_order_relaxed);
+            if (write - read.load(std::memory_order_acquire) >= ring.size())
+                break;
+
+            Frame& frame = ring[write % ring.size()];
+            if (!stream->next(frame.pixels.data(), frame.delayMilliseconds)) {
+                // A single-frame GIF is a still image; don't keep re-decoding it.
+                if (passFrames <= 1) {
+                    finished = true;
+                    break;
+                }
+                stream->rewind();
+                passFrames = 0;
+                continue;
+            }
+
+            passFrames++;
+            written.store(write + 1, std::memory_order_release);
+        }
+        decoding.store(false, std::memory_order_release);
+    }
+
+    void AnimatedImage::requestDecode() {
+        if (!m_ImageID || m_Decoder->finished || m_Decoder->decoding.exchange(true, std::memory_order_acq_rel))
+            return;
+
+        Application::Get().getThreadPool().enqueue([decoder = m_Decoder] { decoder->fill(); });
+    }
+
+    void AnimatedImage::draw(const ImVec2& size) {
+        m_Drawn = true;
+        ImGui::Image((ImTextureID)(intptr_t)m_ImageID, size);
+    }
+
+    void AnimatedImage::onUpdate(Timestep ts) {
+        if (!m_ImageID || !std::exchange(m_Drawn, false))
+            return;
+
+        Decoder& decoder = *m_Decoder;
+        auto& ring = decoder.ring;
+
+        std::optional<uint64_t> due;
+        if (m_CurrentDelay < 0.0f) {
+            uint64_t read = decoder.read.load(std::memory_order_relaxed);
+            if (read != decoder.written.load(std::memory_order_acquire)) {
+                due = read;
+                m_CurrentDelay = getDelaySeconds(ring[read % ring.size()].delayMilliseconds);
+                m_Elapsed = 0.0f;
+            }
+        }
+        else if (m_Playing) {
+            m_Elapsed += ts;
+            while (m_Elapsed >= m_CurrentDelay) {
+                uint64_t next = due ? *due + 1 : decoder.read.load(std::memory_order_relaxed);
+                if (next == decoder.written.load(std::memory_order_acquire)) {
+                    // Hold the current frame until the decoder catches up.
+                    if (!decoder.finished)
+                        m_Stats.stalls++;
+                    m_Elapsed = m_CurrentDelay;
+                    break;
+                }
+
+                if (due)
+                    m_Stats.framesSkipped++;
+                m_Elapsed -= m_CurrentDelay;
+                m_CurrentDelay = getDelaySeconds(ring[next % ring.size()].delayMilliseconds);
+                due = next;
+            }
+        }
+
+        if (due) {
+            upload(ring[*due % ring.size()]);
+            decoder.read.store(*due + 1, std::memory_order_release);
+            m_Stats.framesShown++;
+        }
+
+        requestDecode();
+    }
+
+    void AnimatedImage::upload(const Frame& frame) {
+        VICA_PROFILE_FUNCTION();
+        glTextureSubImage2D(m_ImageID, 0, 0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, frame.pixels.data());
+        Application::Get().invalidateFrame();
+    }
+
+    size_t AnimatedImage::getMemorySize() const {
+        size_t frameSize = (size_t)m_Width * m_Height * 4;
+        return m_Decoder->ring.size() * frameSize + m_Decoder->stream->getMemorySize();
+    }
+
+} // namespace vica
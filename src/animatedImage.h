@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "base.h"
+#include "slotMap.h"
+#include "timestep.h"
+#include "renderer/texturePool.h"
+
+struct ImVec2;
+
+namespace vica {
+    class GifStream;
+
+    // Animated GIF played back through a single pooled texture. Frames are
+    // decoded on the thread pool into a small ring, so memory stays at
+    // ringSize frames however long the animation is; onUpdate() advances by
+    // each frame's delay and uploads the due frame in place. Only images
+    // drawn (draw() or markDrawn()) since the last update advance, so
+    // off-screen animations cost nothing and resume where they stopped.
+    class AnimatedImage {
+    public:
+        struct Stats {
+            uint64_t framesShown = 0;
+            uint64_t framesSkipped = 0; // due in the same update as a later frame
+            uint64_t stalls = 0;        // updates where the next frame was not decoded yet
+        };
+
+        AnimatedImage(const std::filesystem::path& path, uint32_t ringSize = 4);
+        AnimatedImage(const std::filesystem::path& path, std::vector<uint8_t> file, uint32_t ringSize = 4);
+        ~AnimatedImage();
+
+        AnimatedImage(const AnimatedImage&) = delete;
+        AnimatedImage& operator=(const AnimatedImage&) = delete;
+
+        // Once per frame, after the UI is built.
+        void onUpdate(Timestep ts);
+
+        void draw(const ImVec2& size);
+        // For callers drawing getID() themselves.
+        void markDrawn() { m_Drawn = true; }
+
+        void setPlaying(bool playing) { m_Playing = playing; }
+        bool isPlaying() const { return m_Playing; }
+
+        uint32_t getID() const { return m_ImageID; }
+        uint32_t getWidth() const { return m_Width; }
+        uint32_t getHeight() const { return m_Height; }
+        const std::string& getName() const { return m_Name; }
+        const Stats& getStats() const { return m_Stats; }
+        // CPU-side bytes held for decoding: the frame ring plus decoder state.
+        size_t getMemorySize() const;
+    private:
+        struct Frame {
+            std::vector<uint8_t> pixels;
+            uint32_t delayMilliseconds = 0;
+        };
+
+        // Shared with in-flight decode tasks so destruction never waits on them.
+        struct Decoder {
+            Scope<GifStream> stream;
+            std::vector<Frame> ring;
+            std::atomic<uint64_t> written{ 0 }; // producer
+            std::atomic<uint64_t> read{ 0 };    // consumer
+            std::atomic<bool> decoding{ false };
+            std::atomic<bool> cancelled{ false };
+            std::atomic<bool> finished{ false }; // still image fully decoded
+            uint32_t passFrames = 0;             // frames decoded since the last rewind
+
+            void fill();
+        };
+
+        TextureDesc getTextureDesc() const;
+        void requestDecode();
+        void upload(const Frame& frame);
+    private:
+        std::string m_Name;
+        uint32_t m_Width = 0, m_Height = 0;
+        uint32_t m_ImageID = 0;
+
+        Ref<Decoder> m_Decoder;
+        float m_Elapsed = 0.0f;        // seconds into the current frame
+        float m_CurrentDelay = -1.0f;  // < 0 until the first frame is shown
+        bool m_Playing = true;
+        bool m_Drawn = false;          // since the last onUpdate()
+        Stats m_Stats;
+    };
+
+    using AnimatedImageHandle = Handle<AnimatedImage>;
+
+} // namespace vica
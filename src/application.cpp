@@ -1,12 +1,23 @@
 #include "application.h"
 
 #include <print>
+#include <fstream>
+#include <chrono>
+#include <format>
+#include <thread>
 #include <unordered_set>
+#include <algorithm>
 
 #include "timestep.h"
+#include "memory/allocationTracker.h"
+#include "debug/profiler.h"
+#include "imageDecoder.h"
+#include "fileReader.h"
+#include "renderer/binaryCache.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <stb_image.h>
 
 #include <imgui.h>
 #include <backends/imgui_impl_glfw.h>
@@ -30,6 +41,8 @@ namespace vica {
     }
 
     void Application::init() {
+        Profiler::setThreadName("Main");
+        VICA_PROFILE_FUNCTION();
         if (!glfwInit())
             std::print("glfw is not initialized.");
 
@@ -39,6 +52,8 @@ namespace vica {
 
         if (m_ApplicationSpecs.isInCategory(ApplicationFlag_CustomTitleBar))
             glfwWindowHint(GLFW_DECORATED, GLFW_FALSE);
+        if (m_ApplicationSpecs.isInCategory(ApplicationFlag_Offscreen))
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
         m_Window = glfwCreateWindow(m_ApplicationSpecs.width, m_ApplicationSpecs.height, m_ApplicationSpecs.name, nullptr, nullptr);
         glfwMakeContextCurrent(m_Window);
@@ -46,24 +61,39 @@ namespace vica {
         if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
             std::print("glad not initialized.");
 
-        glfwSwapInterval(1);
+        glfwSwapInterval(m_ApplicationSpecs.isInCategory(ApplicationFlag_Offscreen) ? 0 : 1);
+        if (m_ApplicationSpecs.isInCategory(ApplicationFlag_LowLatency)) {
+            m_FrameLimiter.setMaxFramesInFlight(1);
+            m_LateLatchInput = true;
+        }
+        if (const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor()); mode && mode->refreshRate > 0)
+            m_RefreshInterval = 1.0f / mode->refreshRate;
         initCallbacks();
 
         IMGUI_CHECKVERSION();
+#ifdef VICA_TRACK_ALLOCATIONS
+        ImGui::SetAllocatorFunctions(
+            [](size_t size, void*) { VICA_ALLOC_SCOPE(AllocationTag::ImGui); return ::operator new(size); },
+            [](void* ptr, void*) { ::operator delete(ptr); });
+#endif
         ImGui::CreateContext();
         ImGuiIO& io = ImGui::GetIO(); (void)io;
         io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
 
-        ImGui_ImplGlfw_InitForOpenGL(m_Window, true);
-        ImGui_ImplOpenGL3_Init("#version 460");
+        FontAtlasCache::LoadOrBuild(*io.Fonts);
+        // Our callbacks forward to ImGui's, so replays can keep live input from it.
+        ImGui_ImplGlfw_InitForOpenGL(m_Window, false);
 
-        loadImages();
-    }
+        if (!m_ImGuiRenderer.init()) {
+            std::println("vica ImGui renderer unavailable, using the stock backend.");
+            m_ApplicationSpecs.rendererBackend = ImGuiRendererBackend::Stock;
+        }
+        for (GpuTimer& timer : m_RenderTimers)
+            timer.init();
+        m_FrameCapture.init();
+        m_TexturePool.init(m_FrameLimiter);
 
-    Ref<Image> Application::getImage(const std::string& name) {
-        if (m_Images.find(name) != m_Images.end())
-            return m_Images[name];
-        return nullptr;
+        loadImages();
     }
 
     void Application::run() {
@@ -71,24 +101,42 @@ namespace vica {
 
         while (!glfwWindowShouldClose(m_Window) && m_Running) {
 
-            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT);
+            VICA_PROFILE_SCOPE("Frame");
+            m_FrameLimiter.waitForFrameSlot();
+            m_TexturePool.collect();
 
+            auto frameStart = std::chrono::steady_clock::now();
             float time = (float)glfwGetTime();
             Timestep timestep = time - m_LastFrameTime;
             m_LastFrameTime = time;
 
-            glfwPollEvents();
+            m_InputRecorder.beginFrame(time);
+            if (m_InputRecorder.isReplaying())
+                timestep = m_InputRecorder.getFixedTimestep();
+
+            if (!m_LateLatchInput)
+                processEvents();
 
-            while (!Application::Get().m_EventQueue.empty()) {
-                auto e = Application::Get().m_EventQueue.front();
-                Application::Get().m_EventQueue.pop();
-                onEvent(e);
+            {
+                VICA_PROFILE_SCOPE("Main thread queue");
+                executeMainThreadQueue();
             }
 
+            // Late latch: uploads queued by workers are done, so the input
+            // is as fresh as it can be when the UI is built from it.
+            if (m_LateLatchInput)
+                processEvents();
+
             ImGuiIO& io = ImGui::GetIO(); (void)io;
-            ImGui_ImplOpenGL3_NewFrame();
+            if (m_ApplicationSpecs.rendererBackend == ImGuiRendererBackend::Stock) {
+                // Compiled on first use; startup only pays for the cached vica program.
+                if (!m_StockRendererReady)
+                    m_StockRendererReady = ImGui_ImplOpenGL3_Init("#version 460");
+                ImGui_ImplOpenGL3_NewFrame();
+            }
             ImGui_ImplGlfw_NewFrame();
+            if (m_InputRecorder.isReplaying())
+                io.DeltaTime = timestep;
             ImGui::NewFrame();
 
             auto windowFlags = ImGuiWindowFlags_NoTitleBar |
@@ -102,22 +150,308 @@ namespace vica {
             ImGui::SetNextWindowSize(io.DisplaySize);
             ImGui::Begin("Main Window", nullptr, windowFlags);
 
-            if (m_Scenes.getSceneLibrarySize())
-                getScenes().getActiveScene()->onUpdate(timestep);
+            if (Scene* scene = m_Scenes.getActiveScene()) {
+                VICA_PROFILE_SCOPE("Scene::onUpdate");
+                scene->onUpdate(timestep);
+            }
 
             ImGui::End();
 
-            ImGui::EndFrame();
-            ImGui::Render();
-            glViewport(0, 0, (int)io.DisplaySize.x, (int)io.DisplaySize.y);
+            if (m_ApplicationSpecs.isInCategory(ApplicationFlag_ShowStats))
+                onStatsRender();
+            if (m_ShowImGuiDemo)
+                ImGui::ShowDemoWindow(&m_ShowImGuiDemo);
+
+            {
+                VICA_PROFILE_SCOPE("ImGui::Render");
+                ImGui::EndFrame();
+                ImGui::Render();
+            }
+
+            // Only animations drawn this frame advance; their uploads land
+            // before the damage check and show in this frame.
+            m_AnimatedImages.each([&](AnimatedImage& image) { image.onUpdate(timestep); });
+
+            // Replays are timed per frame, so they always render.
+            if (m_FrameDamage.update(ImGui::GetDrawData(), m_FrameCapture.needsFrame() || m_InputRecorder.isReplaying())) {
+                glViewport(0, 0, (int)io.DisplaySize.x, (int)io.DisplaySize.y);
+                glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+                renderImGui();
+
+                int framebufferWidth, framebufferHeight;
+                glfwGetFramebufferSize(m_Window, &framebufferWidth, &framebufferHeight);
+                m_FrameCapture.onFrameEnd(framebufferWidth, framebufferHeight);
+
+                {
+                    VICA_PROFILE_SCOPE("glfwSwapBuffers");
+                    glfwSwapBuffers(glfwGetCurrentContext());
+                }
+                m_FrameLimiter.onFrameSwapped(m_InputTime);
+            }
+            else {
+                // Without a swap nothing blocks on vsync, so pace the loop here.
+                VICA_PROFILE_SCOPE("Skipped frame");
+                std::this_thread::sleep_until(frameStart + std::chrono::duration<float>(m_RefreshInterval));
+            }
+            m_FrameAllocator.endFrame();
+            AllocationTracker::endFrame();
+
+            if (m_InputRecorder.isReplaying()) {
+                m_ReplayFrameTimes.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+                if (m_InputRecorder.isReplayFinished())
+                    finishReplay();
+            }
+        }
+    }
+
+    void Application::processEvents() {
+        VICA_PROFILE_FUNCTION();
+        VICA_ALLOC_SCOPE(AllocationTag::Events);
+        glfwPollEvents();
+        m_InputTime = std::chrono::steady_clock::now();
+        dispatchReplayedInput();
+
+        // Handlers may queue more events (e.g. glfwSetWindowSize), so re-read the size.
+        for (size_t i = 0; i < m_EventQueue.size(); i++) {
+            Ref<Event> e = m_EventQueue[i];
+            onEvent(e);
+        }
+        m_EventQueue.clear();
+    }
+
+    void Application::dispatchReplayedInput() {
+        if (!m_InputRecorder.isReplaying())
+            return;
+
+        // Replayed input goes through the same callbacks as live input, which
+        // forward to ImGui's, so ImGui and the event queue see exactly what
+        // was recorded. Live input is dropped meanwhile; the cursor counts as
+        // inside the window so the backend never polls the real one.
+        m_DispatchingReplay = true;
+        ImGui_ImplGlfw_CursorEnterCallback(m_Window, GLFW_TRUE);
+        const InputRecord* resize = nullptr;
+        for (const InputRecord& record : m_InputRecorder.getFrameRecords()) {
+            const int32_t* args = record.args;
+            switch (record.type) {
+            case InputRecordType::Key:         keyCallback(m_Window, args[0], args[1], args[2], args[3]); break;
+            case InputRecordType::Char:        charCallback(m_Window, (uint32_t)args[0]); break;
+            case InputRecordType::MouseButton: mouseButtonCallback(m_Window, args[0], args[1], args[2]); break;
+            case InputRecordType::Scroll:      scrollCallback(m_Window, record.x, record.y); break;
+            case InputRecordType::CursorPos:   cursorPosCallback(m_Window, record.x, record.y); break;
+            case InputRecordType::WindowSize:  windowSizeCallback(m_Window, args[0], args[1]); resize = &record; break;
+            case InputRecordType::WindowClose: m_EventQueue.push_back(CreateFrameRef<WindowCloseEvent>(m_FrameAllocator)); break;
+            default: break;
+            }
+        }
+        m_DispatchingReplay = false;
+
+        // The resize event is already queued; the window follows outside the
+        // dispatch, so the size callback it triggers (now or on a later poll)
+        // is dropped like any other live input.
+        if (resize)
+            glfwSetWindowSize(m_Window, resize->args[0], resize->args[1]);
+    }
+
+    void Application::finishReplay() {
+        std::vector<float> times = m_ReplayFrameTimes;
+        std::sort(times.begin(), times.end());
+
+        float total = 0.0f;
+        for (float t : times)
+            total += t;
+
+        if (!times.empty())
+            std::println("Replay: {} frames, {:.1f} ms total, mean {:.3f} ms, p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms",
+                times.size(), total, total / times.size(), times[times.size() / 2], times[times.size() * 99 / 100], times.back());
+
+        // ImGui render cost per frame, for every backend that drew during the replay.
+        for (auto [name, index] : { std::pair{ "vica", ImGuiRendererBackend::Vica }, std::pair{ "stock", ImGuiRendererBackend::Stock } }) {
+            std::vector<float>& cpuTimes = m_ReplayRenderCpuTimes[(size_t)index];
+            GpuTimer& timer = m_RenderTimers[(size_t)index];
+            timer.finish();
+            if (!cpuTimes.empty()) {
+                std::sort(cpuTimes.begin(), cpuTimes.end());
+                float cpuTotal = 0.0f;
+                for (float t : cpuTimes)
+                    cpuTotal += t;
+                double gpuMean = timer.getSampleCount() ? timer.getTotalMilliseconds() / timer.getSampleCount() : 0.0;
+                std::println("Renderer {}: {} frames, CPU mean {:.3f} ms, p50 {:.3f} ms, p99 {:.3f} ms; GPU mean {:.3f} ms ({} samples)",
+                    name, cpuTimes.size(), cpuTotal / cpuTimes.size(), cpuTimes[cpuTimes.size() / 2], cpuTimes[cpuTimes.size() * 99 / 100],
+                    gpuMean, timer.getSampleCount());
+            }
+            cpuTimes.clear();
+            timer.resetTotals();
+        }
+
+        m_InputRecorder.stopReplay();
+        m_ReplayFrameTimes.clear();
+        if (m_ApplicationSpecs.isInCategory(ApplicationFlag_Offscreen))
+            m_Running = false;
+    }
+
+    void Application::renderImGui() {
+        VICA_PROFILE_FUNCTION();
+        size_t backend = (size_t)m_ApplicationSpecs.rendererBackend;
+        auto start = std::chrono::steady_clock::now();
+        m_RenderTimers[backend].begin();
+
+        // The stock backend starts with the next NewFrame after being selected.
+        if (m_ApplicationSpecs.rendererBackend == ImGuiRendererBackend::Vica || !m_StockRendererReady)
+            m_ImGuiRenderer.renderDrawData(ImGui::GetDrawData());
+        else
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-            glfwSwapBuffers(glfwGetCurrentContext());
+        m_RenderTimers[backend].end();
+        float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        m_RenderCpuTimes[backend] = m_RenderCpuTimes[backend] == 0.0f ? milliseconds : m_RenderCpuTimes[backend] * 0.95f + milliseconds * 0.05f;
+        if (m_InputRecorder.isReplaying())
+            m_ReplayRenderCpuTimes[backend].push_back(milliseconds);
+    }
+
+    void Application::submitToMainThread(std::function<void()> func) {
+        std::lock_guard lock(m_MainThreadQueueMutex);
+        m_MainThreadQueue.emplace_back(std::move(func));
+    }
+
+    void Application::executeMainThreadQueue() {
+        std::vector<std::function<void()>> queue;
+        {
+            std::lock_guard lock(m_MainThreadQueueMutex);
+            queue.swap(m_MainThreadQueue);
+        }
+
+        for (auto& func : queue)
+            func();
+    }
+
+    void Application::onStatsRender() {
+        ImGui::Begin("Stats", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+
+        ImGui::Text("%.1f FPS (%.2f ms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+
+        if (ImGui::CollapsingHeader("Frame arena")) {
+            const auto& arenaStats = m_FrameAllocator.getStats();
+            ImGui::Text("Last frame: %zu bytes", arenaStats.lastFrameBytes);
+            ImGui::Text("High-water: %zu bytes", arenaStats.highWater);
+            ImGui::Text("Capacity:   %zu bytes", arenaStats.capacity);
+        }
+
+        if (ImGui::CollapsingHeader("Renderer")) {
+            auto& backend = m_ApplicationSpecs.rendererBackend;
+            if (ImGui::RadioButton("vica (persistent-mapped, MDI)", backend == ImGuiRendererBackend::Vica))
+                backend = ImGuiRendererBackend::Vica;
+            if (ImGui::RadioButton("imgui_impl_opengl3", backend == ImGuiRendererBackend::Stock))
+                backend = ImGuiRendererBackend::Stock;
+            ImGui::Checkbox("ImGui demo window (UI load)", &m_ShowImGuiDemo);
+
+            // Both backends keep their own smoothed timings for A/B comparison.
+            for (auto [name, index] : { std::pair{ "vica", ImGuiRendererBackend::Vica }, std::pair{ "stock", ImGuiRendererBackend::Stock } })
+                ImGui::Text("%-6s CPU %.3f ms  GPU %.3f ms", name, m_RenderCpuTimes[(size_t)index], m_RenderTimers[(size_t)index].getMilliseconds());
+
+            const auto& rendererStats = m_ImGuiRenderer.getStats();
+            ImGui::Text("vica: %u commands in %u draw calls, %u vertices, %u indices",
+                rendererStats.commands, rendererStats.drawCalls, rendererStats.vertices, rendererStats.indices);
+
+            bool skipUnchanged = m_FrameDamage.isEnabled();
+            if (ImGui::Checkbox("Skip unchanged frames", &skipUnchanged))
+                m_FrameDamage.setEnabled(skipUnchanged);
+            const auto& damageStats = m_FrameDamage.getStats();
+            ImGui::Text("Presented %llu, skipped %llu (%llu in a row)", (unsigned long long)damageStats.presented,
+                (unsigned long long)damageStats.skipped, (unsigned long long)damageStats.skippedStreak);
+
+            for (auto [name, stats] : { std::pair{ "Program binaries", &ProgramCache::GetStats() }, std::pair{ "Font atlas", &FontAtlasCache::GetStats() } })
+                ImGui::Text("%-16s %u hit, %u miss, %u rejected, %.2f ms", name, stats->hits, stats->misses, stats->rejected, stats->milliseconds);
         }
+
+        if (ImGui::CollapsingHeader("Latency")) {
+            int maxFramesInFlight = (int)m_FrameLimiter.getMaxFramesInFlight();
+            if (ImGui::SliderInt("Max frames in flight (0 = driver)", &maxFramesInFlight, 0, 4))
+                m_FrameLimiter.setMaxFramesInFlight((uint32_t)maxFramesInFlight);
+            ImGui::Checkbox("Late-latch input", &m_LateLatchInput);
+
+            const auto& latencyStats = m_FrameLimiter.getStats();
+            ImGui::Text("Input to present %.2f ms (max %.2f ms), waited %.2f ms, %u in flight",
+                latencyStats.latencyMilliseconds, latencyStats.maxLatencyMilliseconds, latencyStats.waitMilliseconds, latencyStats.framesInFlight);
+            ImGui::PlotLines("##latency", m_FrameLimiter.getHistory(), (int)FrameLimiter::HistorySize, (int)m_FrameLimiter.getHistoryOffset(),
+                "input to present (ms)", 0.0f, FLT_MAX, { 0, 40 });
+        }
+
+        if (ImGui::CollapsingHeader("Capture")) {
+            if (ImGui::Button("Screenshot (F12)"))
+                m_FrameCapture.requestScreenshot();
+            ImGui::SameLine();
+            if (!m_FrameCapture.isRecording() && ImGui::Button("Record"))
+                m_FrameCapture.startRecording("capture");
+            else if (m_FrameCapture.isRecording() && ImGui::Button("Stop"))
+                m_FrameCapture.stopRecording();
+
+            auto captureStats = m_FrameCapture.getStats();
+            ImGui::Text("Captured %llu, written %llu, dropped %llu (ring full) + %llu (queue full), queued %zu bytes",
+                (unsigned long long)captureStats.captured, (unsigned long long)captureStats.written,
+                (unsigned long long)captureStats.droppedRingFull, (unsigned long long)captureStats.droppedQueueFull, captureStats.queuedBytes);
+        }
+
+        if (ImGui::CollapsingHeader("Image decoders")) {
+            ImageDecoder::OnImGuiRender();
+
+            size_t tileBytes = 0;
+            m_TiledImages.each([&](const TiledImage& image) {
+                tileBytes += (size_t)image.getStats().residentTiles * (image.getTileSize() + 2) * (image.getTileSize() + 2) * 4;
+                });
+            ImGui::Text("Texture memory: %.1f MiB images, %.1f MiB tiles", Image::GetTextureMemory() / 1048576.0, tileBytes / 1048576.0);
+            m_TiledImages.each([](const TiledImage& image) {
+                const auto& stats = image.getStats();
+                ImGui::Text("%s: %u bands decoded, %.1f MiB cached bands, %.1f MiB resident levels", image.getName().c_str(),
+                    stats.bandDecodes, stats.cachedBandBytes / 1048576.0, stats.residentLevelBytes / 1048576.0);
+                });
+
+            const auto& poolStats = m_TexturePool.getStats();
+            ImGui::Text("Texture pool: %.0f%% of %llu reused, %u pending, %u pooled (%.1f MiB), %llu evicted",
+                poolStats.requests ? 100.0 * poolStats.hits / poolStats.requests : 0.0, (unsigned long long)poolStats.requests,
+                poolStats.pending, poolStats.available, poolStats.availableBytes / 1048576.0, (unsigned long long)poolStats.evicted);
+
+            m_AnimatedImages.each([](const AnimatedImage& image) {
+                const auto& stats = image.getStats();
+                ImGui::Text("%s: %llu shown, %llu skipped, %llu stalls, %.1f MiB decode memory", image.getName().c_str(),
+                    (unsigned long long)stats.framesShown, (unsigned long long)stats.framesSkipped, (unsigned long long)stats.stalls, image.getMemorySize() / 1048576.0);
+                });
+        }
+
+        if (Profiler::isEnabled() && ImGui::CollapsingHeader("Profiler")) {
+            if (ImGui::Button("Write trace"))
+                Profiler::flush(std::format("trace_{:%Y%m%d_%H%M%S}.json", std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now())));
+            ImGui::SameLine();
+            ImGui::TextDisabled("(open in ui.perfetto.dev)");
+        }
+
+        if (ImGui::CollapsingHeader("Heap allocations")) {
+            AllocationTracker::onImGuiRender();
+            if (AllocationTracker::isEnabled() && ImGui::Button("Export allocations.json"))
+                std::ofstream("allocations.json") << AllocationTracker::toJson();
+        }
+
+        ImGui::End();
     }
 
     void Application::close() {
-        ImGui_ImplOpenGL3_Shutdown();
+        m_ThreadPool.shutdown();
+        m_MainThreadQueue.clear();
+        m_InputRecorder.stopRecording();
+        if (Profiler::isEnabled())
+            Profiler::flush("trace.json");
+
+        const auto& arenaStats = m_FrameAllocator.getStats();
+        std::println("Frame arena high-water mark: {} bytes (capacity {} bytes)", arenaStats.highWater, arenaStats.capacity);
+
+        m_FrameCapture.shutdown();
+        for (GpuTimer& timer : m_RenderTimers)
+            timer.shutdown();
+        m_TexturePool.shutdown();
+        m_FrameLimiter.shutdown();
+        m_ImGuiRenderer.shutdown();
+        if (m_StockRendererReady)
+            ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
 
@@ -138,6 +472,11 @@ namespace vica {
     }
 
     bool onKeyPressed(KeyPressedEvent& e) {
+        auto& app = Application::Get();
+        if (e.getKey() == KeyCode::F3 && !e.IsRepeat())
+            app.getSpecs().applicationFlag ^= ApplicationFlag_ShowStats;
+        if (e.getKey() == KeyCode::F12 && !e.IsRepeat())
+            app.getFrameCapture().requestScreenshot();
         return true;
     }
 
@@ -193,6 +532,8 @@ namespace vica {
     }
 
     void Application::loadImages() {
+        VICA_PROFILE_FUNCTION();
+        VICA_ALLOC_SCOPE(AllocationTag::Images);
         std::filesystem::path imageDir("res");
 
         static const std::unordered_set<std::string> stb_image_extensions = {
@@ -206,13 +547,50 @@ namespace vica {
                 throw std::runtime_error{ "Failed to create directory: " + imageDir.string() + ": " + ec.message() };
         }
 
+        // Larger files show a placeholder while they decode in the background.
+        static constexpr uintmax_t progressiveThreshold = 1024 * 1024;
+
+        GLint maxTextureSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+        std::vector<std::filesystem::path> paths;
         for (const auto& entry : std::filesystem::recursive_directory_iterator(imageDir))
             if (entry.is_regular_file()) {
                 std::string ext = entry.path().extension().string();
                 std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
                 if (stb_image_extensions.contains(ext))
-                    m_Images[entry.path().filename().string()] = CreateRef<Image>(entry.path());
+                    paths.push_back(entry.path());
+            }
+
+        // Every file is read in one batch so a cold disk sees a deep queue.
+        std::println("Reading {} images with {}", paths.size(), FileReader::GetBackendName(FileReadBackend::Auto));
+        std::vector<FileReadResult> files = FileReader::ReadAll(paths, m_ThreadPool);
+
+        for (size_t i = 0; i < paths.size(); i++) {
+            const std::filesystem::path& path = paths[i];
+            std::vector<uint8_t>& file = files[i].data;
+            if (!files[i].ok) {
+                std::println("Failed to read {}", path.string());
+                continue;
             }
+
+            std::string name = path.filename().string();
+            std::string ext = path.extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+            // Images that cannot fit in a single texture are streamed as tiles.
+            int width, height, channels;
+            if (stbi_info_from_memory(file.data(), (int)file.size(), &width, &height, &channels) && (width > maxTextureSize || height > maxTextureSize))
+                m_TiledImages.add(name, CreateRef<TiledImage>(path, std::move(file)));
+            // GIFs stream their frames through a fixed-size ring.
+            else if (ext == ".gif")
+                m_AnimatedImages.add(name, CreateRef<AnimatedImage>(path, std::move(file)));
+            // Half-float conversion of .hdr and 16-bit images runs on the thread pool too.
+            else if (file.size() > progressiveThreshold || stbi_is_hdr_from_memory(file.data(), (int)file.size()) || stbi_is_16_bit_from_memory(file.data(), (int)file.size()))
+                m_Images.add(name, Image::CreateProgressive(path, std::move(file)));
+            else
+                m_Images.add(name, CreateRef<Image>(path, file));
+        }
     }
 
     void Application::initCallbacks() {
@@ -220,42 +598,96 @@ namespace vica {
             fprintf(stderr, "GLFW Error %d: %s\n", error, description);
             });
 
-        glfwSetWindowSizeCallback(m_Window, [](GLFWwindow* window, int width, int height) {
-            auto& app = Application::Get();
-            if (app.m_ApplicationSpecs.width != width || app.m_ApplicationSpecs.height != height)
-                app.m_EventQueue.push(CreateRef<WindowResizeEvent>(width, height));
+        glfwSetWindowSizeCallback(m_Window, windowSizeCallback);
+
+        // The compositor or window system lost our contents (exposed, restored).
+        glfwSetWindowRefreshCallback(m_Window, [](GLFWwindow* window) {
+            Application::Get().invalidateFrame();
             });
 
         glfwSetWindowCloseCallback(m_Window, [](GLFWwindow* window) {
-            Application::Get().m_EventQueue.push(CreateRef<WindowCloseEvent>());
+            auto& app = Application::Get();
+            app.m_InputRecorder.record({ .type = InputRecordType::WindowClose });
+            app.m_EventQueue.push_back(CreateFrameRef<WindowCloseEvent>(app.m_FrameAllocator));
             });
 
-        glfwSetKeyCallback(m_Window, [](GLFWwindow* window, int key, int scanCode, int action, int modes) {
-            switch (action) {
-            case GLFW_PRESS:    Application::Get().m_EventQueue.push(CreateRef<KeyPressedEvent>((KeyCode)key, false)); break;
-            case GLFW_RELEASE:  Application::Get().m_EventQueue.push(CreateRef<KeyReleasedEvent>((KeyCode)key)); break;
-            case GLFW_REPEAT:   Application::Get().m_EventQueue.push(CreateRef<KeyPressedEvent>((KeyCode)key, true)); break;
-            }
-            });
+        glfwSetKeyCallback(m_Window, keyCallback);
+        glfwSetCharCallback(m_Window, charCallback);
+        glfwSetMouseButtonCallback(m_Window, mouseButtonCallback);
+        glfwSetScrollCallback(m_Window, scrollCallback);
+        glfwSetCursorPosCallback(m_Window, cursorPosCallback);
 
-        glfwSetCharCallback(m_Window, [](GLFWwindow* window, uint32_t keycode) {
-            Application::Get().m_EventQueue.push(CreateRef<KeyTypedEvent>((KeyCode)keycode));
+        // Not recorded; ImGui only needs them to track hover and focus.
+        glfwSetCursorEnterCallback(m_Window, [](GLFWwindow* window, int entered) {
+            if (Application::Get().acceptsLiveInput())
+                ImGui_ImplGlfw_CursorEnterCallback(window, entered);
             });
 
-        glfwSetMouseButtonCallback(m_Window, [](GLFWwindow* window, int button, int action, int modes) {
-            switch (action) {
-            case GLFW_PRESS:    Application::Get().m_EventQueue.push(CreateRef<MouseButtonPressedEvent>((MouseButton)button)); break;
-            case GLFW_RELEASE:  Application::Get().m_EventQueue.push(CreateRef<MouseButtonReleasedEvent>((MouseButton)button)); break;
-            }
+        glfwSetWindowFocusCallback(m_Window, [](GLFWwindow* window, int focused) {
+            if (Application::Get().acceptsLiveInput())
+                ImGui_ImplGlfw_WindowFocusCallback(window, focused);
             });
+    }
 
-        glfwSetScrollCallback(m_Window, [](GLFWwindow* window, double xOffset, double yOffset) {
-            Application::Get().m_EventQueue.push(CreateRef<MouseScrolledEvent>((float)xOffset, (float)yOffset));
-            });
+    void Application::keyCallback(GLFWwindow* window, int key, int scanCode, int action, int modes) {
+        auto& app = Application::Get();
+        if (!app.acceptsLiveInput())
+            return;
+        ImGui_ImplGlfw_KeyCallback(window, key, scanCode, action, modes);
+        app.m_InputRecorder.record({ .type = InputRecordType::Key, .args = { key, scanCode, action, modes } });
+        switch (action) {
+        case GLFW_PRESS:    app.m_EventQueue.push_back(CreateFrameRef<KeyPressedEvent>(app.m_FrameAllocator, (KeyCode)key, false)); break;
+        case GLFW_RELEASE:  app.m_EventQueue.push_back(CreateFrameRef<KeyReleasedEvent>(app.m_FrameAllocator, (KeyCode)key)); break;
+        case GLFW_REPEAT:   app.m_EventQueue.push_back(CreateFrameRef<KeyPressedEvent>(app.m_FrameAllocator, (KeyCode)key, true)); break;
+        }
+    }
 
-        glfwSetCursorPosCallback(m_Window, [](GLFWwindow* window, double xPos, double yPos) {
-            Application::Get().m_EventQueue.push(CreateRef<MouseMovedEvent>(xPos, yPos));
-            });
+    void Application::charCallback(GLFWwindow* window, uint32_t keycode) {
+        auto& app = Application::Get();
+        if (!app.acceptsLiveInput())
+            return;
+        ImGui_ImplGlfw_CharCallback(window, keycode);
+        app.m_InputRecorder.record({ .type = InputRecordType::Char, .args = { (int32_t)keycode } });
+        app.m_EventQueue.push_back(CreateFrameRef<KeyTypedEvent>(app.m_FrameAllocator, (KeyCode)keycode));
+    }
+
+    void Application::mouseButtonCallback(GLFWwindow* window, int button, int action, int modes) {
+        auto& app = Application::Get();
+        if (!app.acceptsLiveInput())
+            return;
+        ImGui_ImplGlfw_MouseButtonCallback(window, button, action, modes);
+        app.m_InputRecorder.record({ .type = InputRecordType::MouseButton, .args = { button, action, modes } });
+        switch (action) {
+        case GLFW_PRESS:    app.m_EventQueue.push_back(CreateFrameRef<MouseButtonPressedEvent>(app.m_FrameAllocator, (MouseButton)button)); break;
+        case GLFW_RELEASE:  app.m_EventQueue.push_back(CreateFrameRef<MouseButtonReleasedEvent>(app.m_FrameAllocator, (MouseButton)button)); break;
+        }
+    }
+
+    void Application::scrollCallback(GLFWwindow* window, double xOffset, double yOffset) {
+        auto& app = Application::Get();
+        if (!app.acceptsLiveInput())
+            return;
+        ImGui_ImplGlfw_ScrollCallback(window, xOffset, yOffset);
+        app.m_InputRecorder.record({ .type = InputRecordType::Scroll, .x = xOffset, .y = yOffset });
+        app.m_EventQueue.push_back(CreateFrameRef<MouseScrolledEvent>(app.m_FrameAllocator, (float)xOffset, (float)yOffset));
+    }
+
+    void Application::cursorPosCallback(GLFWwindow* window, double xPos, double yPos) {
+        auto& app = Application::Get();
+        if (!app.acceptsLiveInput())
+            return;
+        ImGui_ImplGlfw_CursorPosCallback(window, xPos, yPos);
+        app.m_InputRecorder.record({ .type = InputRecordType::CursorPos, .x = xPos, .y = yPos });
+        app.m_EventQueue.push_back(CreateFrameRef<MouseMovedEvent>(app.m_FrameAllocator, xPos, yPos));
+    }
+
+    void Application::windowSizeCallback(GLFWwindow* window, int width, int height) {
+        auto& app = Application::Get();
+        if (!app.acceptsLiveInput())
+            return;
+        app.m_InputRecorder.record({ .type = InputRecordType::WindowSize, .args = { width, height } });
+        if (app.m_ApplicationSpecs.width != width || app.m_ApplicationSpecs.height != height)
+            app.m_EventQueue.push_back(CreateFrameRef<WindowResizeEvent>(app.m_FrameAllocator, width, height));
     }
 
 } // namespace vica
\ No newline at end of file
@@ -1,12 +1,26 @@
 #pragma once
 #include <string>
-#include <queue>
 #include <functional>
+#include <mutex>
+#include <vector>
+#include <chrono>
 
 #include "base.h"
 #include "event/event.h"
 #include "scene.h"
 #include "image.h"
+#include "tiledImage.h"
+#include "animatedImage.h"
+#include "assetRegistry.h"
+#include "memory/frameAllocator.h"
+#include "threadPool.h"
+#include "renderer/imGuiRenderer.h"
+#include "renderer/gpuTimer.h"
+#include "renderer/frameCapture.h"
+#include "renderer/frameDamage.h"
+#include "renderer/frameLimiter.h"
+#include "renderer/texturePool.h"
+#include "debug/inputRecorder.h"
 
 
 struct GLFWwindow;
@@ -16,6 +30,9 @@ enum ApplicationFlag_ {
     ApplicationFlag_None = 0,
     ApplicationFlag_Minimized = 1 << 0,
     ApplicationFlag_CustomTitleBar = 1 << 1,
+    ApplicationFlag_ShowStats = 1 << 2,
+    ApplicationFlag_Offscreen = 1 << 3, // hidden window, no vsync; for benchmark runs
+    ApplicationFlag_LowLatency = 1 << 4, // one frame in flight, input polled just before the UI build
 };
 
 namespace vica {
@@ -25,6 +42,7 @@ namespace vica {
         int height = 300;
 
         ApplicationFlag applicationFlag = ApplicationFlag_None;
+        ImGuiRendererBackend rendererBackend = ImGuiRendererBackend::Vica;
 
         bool isInCategory(ApplicationFlag_ flag) { return applicationFlag & flag; }
     };
@@ -34,31 +52,86 @@ namespace vica {
         Application(const char* title, int width, int height, ApplicationFlag flags);
         ~Application();
 
-        Ref<Image> getImage(const std::string& name);
+        ImageHandle findImage(const std::string& name) const { return m_Images.find(name); }
+        Image* getImage(ImageHandle handle) const { return m_Images.get(handle); }
+        Image* getImage(const std::string& name) const { return m_Images.get(m_Images.find(name)); }
+        TiledImageHandle findTiledImage(const std::string& name) const { return m_TiledImages.find(name); }
+        TiledImage* getTiledImage(TiledImageHandle handle) const { return m_TiledImages.get(handle); }
+        AnimatedImageHandle findAnimatedImage(const std::string& name) const { return m_AnimatedImages.find(name); }
+        AnimatedImage* getAnimatedImage(AnimatedImageHandle handle) const { return m_AnimatedImages.get(handle); }
         bool contains_stb_supported_images(const std::filesystem::path& directory);
         void run();
         void setCustomTitleBar(std::function<void(Timestep)> func) { m_CustomTitleBar = func; }
-        inline std::function<void(Timestep)> getCustomTitleBar() { return m_CustomTitleBar; }
+        inline const std::function<void(Timestep)>& getCustomTitleBar() const { return m_CustomTitleBar; }
 
         inline static Application& Get() { return *s_Instance; }
         inline GLFWwindow* getWindowHandle() { return m_Window; }
         ApplicationSpecifications& getSpecs() { return m_ApplicationSpecs; }
         SceneLibrary& getScenes() { return m_Scenes; }
+        FrameAllocator& getFrameAllocator() { return m_FrameAllocator; }
+        ThreadPool& getThreadPool() { return m_ThreadPool; }
+        FrameCapture& getFrameCapture() { return m_FrameCapture; }
+        InputRecorder& getInputRecorder() { return m_InputRecorder; }
+        TexturePool& getTexturePool() { return m_TexturePool; }
+
+        // Forces the next frame to be presented; call after changing a texture's contents in place.
+        void invalidateFrame() { m_FrameDamage.invalidate(); }
+
+        // Runs func on the main thread (with the GL context current) at the start of the next frame.
+        void submitToMainThread(std::function<void()> func);
     private:
         void init();
         void close();
 
         void loadImages();
         void initCallbacks();
+        static void keyCallback(GLFWwindow* window, int key, int scanCode, int action, int modes);
+        static void charCallback(GLFWwindow* window, uint32_t keycode);
+        static void mouseButtonCallback(GLFWwindow* window, int button, int action, int modes);
+        static void scrollCallback(GLFWwindow* window, double xOffset, double yOffset);
+        static void cursorPosCallback(GLFWwindow* window, double xPos, double yPos);
+        static void windowSizeCallback(GLFWwindow* window, int width, int height);
         void onEvent(Ref<Event> e);
+        void onStatsRender();
+        void executeMainThreadQueue();
+        void processEvents();
+        void renderImGui();
+        void dispatchReplayedInput();
+        void finishReplay();
+        bool acceptsLiveInput() const { return !m_InputRecorder.isReplaying() || m_DispatchingReplay; }
     private:
         static Application* s_Instance;
         GLFWwindow* m_Window;
 
         ApplicationSpecifications m_ApplicationSpecs;
-        std::queue<Ref<Event>> m_EventQueue;
+        FrameAllocator m_FrameAllocator; // declared before anything holding frame memory
+        std::vector<Ref<Event>> m_EventQueue; // drained by index and cleared, so capacity is kept
         SceneLibrary m_Scenes;
-        std::unordered_map<std::string, Ref<Image>> m_Images;
+        TexturePool m_TexturePool; // outlives the images returning textures to it
+        AssetRegistry<Image> m_Images;
+        AssetRegistry<TiledImage> m_TiledImages;
+        AssetRegistry<AnimatedImage> m_AnimatedImages;
+
+        ImGuiRenderer m_ImGuiRenderer;
+        bool m_StockRendererReady = false;
+        GpuTimer m_RenderTimers[2];
+        float m_RenderCpuTimes[2] = {};
+        bool m_ShowImGuiDemo = false;
+        FrameCapture m_FrameCapture;
+        FrameDamage m_FrameDamage;
+        float m_RefreshInterval = 1.0f / 60.0f;
+        FrameLimiter m_FrameLimiter;
+        bool m_LateLatchInput = false;
+        std::chrono::steady_clock::time_point m_InputTime;
+
+        InputRecorder m_InputRecorder;
+        bool m_DispatchingReplay = false;
+        std::vector<float> m_ReplayFrameTimes;
+        std::vector<float> m_ReplayRenderCpuTimes[2]; // per backend
+
+        ThreadPool m_ThreadPool;
+        std::mutex m_MainThreadQueueMutex;
+        std::vector<std::function<void()>> m_MainThreadQueue;
 
         float m_LastFrameTime;
         bool m_Running = true;
@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+
+#include "base.h"
+#include "slotMap.h"
+#include "uuid.h"
+
+namespace vica {
+    // Name/UUID lookups resolve to a Handle once; per-frame access goes
+    // through get(handle), which is an index plus a generation check and
+    // never touches the shared_ptr refcount.
+    template<typename T>
+    class AssetRegistry {
+    public:
+        using AssetHandle = Handle<T>;
+
+        AssetHandle add(const std::string& name, Ref<T> asset, UUID id = UUID()) {
+            if (auto it = m_NameLookup.find(name); it != m_NameLookup.end())
+                return it->second;
+
+            AssetHandle handle = m_Assets.insert(Entry{ std::move(asset), id });
+            m_NameLookup.emplace(name, handle);
+            m_UUIDLookup.emplace(id, handle);
+            return handle;
+        }
+
+        bool remove(AssetHandle handle) {
+            Entry* entry = m_Assets.get(handle);
+            if (!entry)
+                return false;
+
+            m_UUIDLookup.erase(entry->id);
+            std::erase_if(m_NameLookup, [handle](const auto& pair) { return pair.second == handle; });
+            return m_Assets.remove(handle);
+        }
+
+        AssetHandle find(const std::string& name) const {
+            auto it = m_NameLookup.find(name);
+            return it != m_NameLookup.end() ? it->second : AssetHandle{};
+        }
+
+        AssetHandle find(UUID id) const {
+            auto it = m_UUIDLookup.find(id);
+            return it != m_UUIDLookup.end() ? it->second : AssetHandle{};
+        }
+
+        T* get(AssetHandle handle) const {
+            const Entry* entry = m_Assets.get(handle);
+            return entry ? entry->asset.get() : nullptr;
+        }
+
+        Ref<T> getRef(AssetHandle handle) const {
+            const Entry* entry = m_Assets.get(handle);
+            return entry ? entry->asset : nullptr;
+        }
+
+        UUID getUUID(AssetHandle handle) const {
+            const Entry* entry = m_Assets.get(handle);
+            return entry ? entry->id : UUID(0);
+        }
+
+        bool contains(AssetHandle handle) const { return m_Assets.contains(handle); }
+        size_t size() const { return m_Assets.size(); }
+
+        template<typename F>
+        void each(F&& func) const {
+            for (const Entry& entry : m_Assets)
+                func(*entry.asset);
+        }
+    private:
+        struct Entry {
+            Ref<T> asset;
+            UUID id;
+        };
+
+        SlotMap<Entry, T> m_Assets;
+        std::unordered_map<std::string, AssetHandle> m_NameLookup;
+        std::unordered_map<UUID, AssetHandle> m_UUIDLookup;
+    };
+
+} // namespace vica
@@ -0,0 +1,190 @@
+#include "inputRecorder.h"
+
+#include <cstring>
+#include <print>
+
+namespace vica {
+
+    namespace {
+        constexpr char Magic[4] = { 'V', 'I', 'N', 'P' };
+        constexpr uint16_t Version = 1;
+
+        template<typename T>
+        void write(std::ofstream& file, T value) {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        bool read(std::ifstream& file, T& value) {
+            return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(T));
+        }
+    }
+
+    bool InputRecorder::startRecording(const std::filesystem::path& path, float fixedTimestep) {
+        stopReplay();
+        m_File.open(path, std::ios::binary | std::ios::trunc);
+        if (!m_File) {
+            std::println("Failed to open input trace {} for writing", path.string());
+            return false;
+        }
+
+        m_File.write(Magic, sizeof(Magic));
+        write<uint16_t>(m_File, Version);
+        write<uint16_t>(m_File, 0);
+        write<float>(m_File, fixedTimestep);
+
+        m_FixedTimestep = fixedTimestep;
+        m_Frame = UINT32_MAX;
+        m_StartTime = -1.0;
+        m_Recording = true;
+        return true;
+    }
+
+    void InputRecorder::stopRecording() {
+        if (!m_Recording)
+            return;
+
+        InputRecord end;
+        end.type = InputRecordType::End;
+        record(end);
+        m_File.close();
+        m_Recording = false;
+    }
+
+    bool InputRecorder::startReplay(const std::filesystem::path& path) {
+        stopRecording();
+
+        std::ifstream file(path, std::ios::binary);
+        char magic[4];
+        uint16_t version, reserved;
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, Magic, sizeof(Magic)) || !read(file, version) || version != Version
+            || !read(file, reserved) || !read(file, m_FixedTimestep)) {
+            std::println("Failed to read input trace {}", path.string());
+            return false;
+        }
+
+        m_Records.clear();
+        m_LastFrame = 0;
+        InputRecord record;
+        while (read(file, record.frame) && read(file, record.time) && read(file, record.type)) {
+            m_LastFrame = record.frame;
+            switch (record.type) {
+            case InputRecordType::Key: {
+                int16_t key, scanCode;
+                uint8_t action, mods;
+                read(file, key); read(file, scanCode); read(file, action); read(file, mods);
+                record.args[0] = key; record.args[1] = scanCode; record.args[2] = action; record.args[3] = mods;
+                break;
+            }
+            case InputRecordType::Char: {
+                uint32_t codepoint;
+                read(file, codepoint);
+                record.args[0] = (int32_t)codepoint;
+                break;
+            }
+            case InputRecordType::MouseButton: {
+                uint8_t button, action, mods;
+                read(file, button); read(file, action); read(file, mods);
+                record.args[0] = button; record.args[1] = action; record.args[2] = mods;
+                break;
+            }
+            case InputRecordType::Scroll:
+            case InputRecordType::CursorPos: {
+                float x, y;
+                read(file, x); read(file, y);
+                record.x = x; record.y = y;
+                break;
+            }
+            case InputRecordType::WindowSize:
+                read(file, record.args[0]); read(file, record.args[1]);
+                break;
+            case InputRecordType::WindowClose:
+            case InputRecordType::End:
+                break;
+            default:
+                std::println("Corrupt input trace {}", path.string());
+                return false;
+            }
+            if (!file)
+                break;
+            if (record.type != InputRecordType::End)
+                m_Records.push_back(record);
+            record = {};
+        }
+
+        m_Cursor = m_FrameBegin = 0;
+        m_Frame = UINT32_MAX;
+        m_Replaying = true;
+        return true;
+    }
+
+    void InputRecorder::stopReplay() {
+        m_Replaying = false;
+        m_Records.clear();
+        m_Cursor = m_FrameBegin = 0;
+    }
+
+    void InputRecorder::beginFrame(double time) {
+        m_Frame++;
+
+        if (m_Recording) {
+            if (m_StartTime < 0.0)
+                m_StartTime = time;
+            m_Time = time - m_StartTime;
+        }
+
+        if (m_Replaying) {
+            m_FrameBegin = m_Cursor;
+            while (m_Cursor < m_Records.size() && m_Records[m_Cursor].frame <= m_Frame)
+                m_Cursor++;
+        }
+    }
+
+    void InputRecorder::record(InputRecord record) {
+        if (!m_Recording)
+            return;
+
+        // Input polled before the first beginFrame() belongs to frame 0.
+        record.frame = m_Frame == UINT32_MAX ? 0 : m_Frame;
+        record.time = (float)m_Time;
+        write(m_File, record.frame);
+        write(m_File, record.time);
+        write(m_File, record.type);
+
+        switch (record.type) {
+        case InputRecordType::Key:
+            write<int16_t>(m_File, (int16_t)record.args[0]);
+            write<int16_t>(m_File, (int16_t)record.args[1]);
+            write<uint8_t>(m_File, (uint8_t)record.args[2]);
+            write<uint8_t>(m_File, (uint8_t)record.args[3]);
+            break;
+        case InputRecordType::Char:
+            write<uint32_t>(m_File, (uint32_t)record.args[0]);
+            break;
+        case InputRecordType::MouseButton:
+            write<uint8_t>(m_File, (uint8_t)record.args[0]);
+            write<uint8_t>(m_File, (uint8_t)record.args[1]);
+            write<uint8_t>(m_File, (uint8_t)record.args[2]);
+            break;
+        case InputRecordType::Scroll:
+        case InputRecordType::CursorPos:
+            write<float>(m_File, (float)record.x);
+            write<float>(m_File, (float)record.y);
+            break;
+        case InputRecordType::WindowSize:
+            write<int32_t>(m_File, record.args[0]);
+            write<int32_t>(m_File, record.args[1]);
+            break;
+        case InputRecordType::WindowClose:
+        case InputRecordType::End:
+            break;
+        }
+    }
+
+    std::span<const InputRecord> InputRecorder::getFrameRecords() const {
+        if (!m_Replaying)
+            return {};
+        return std::span<const InputRecord>(m_Records.data() + m_FrameBegin, m_Cursor - m_FrameBegin);
+    }
+
+} // namespace vica
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+namespace vica {
+    enum class InputRecordType : uint8_t {
+        Key,
+        Char,
+        MouseButton,
+        Scroll,
+        CursorPos,
+        WindowSize,
+        WindowClose,
+        End, // written by stopRecording(), marks the last recorded frame
+    };
+
+    struct InputRecord {
+        uint32_t frame = 0;
+        float time = 0.0f; // seconds since recording started
+        InputRecordType type = InputRecordType::Key;
+        int32_t args[4] = {}; // key/scancode/action/mods, codepoint, button/action/mods, width/height
+        double x = 0.0, y = 0.0; // scroll offsets, cursor position
+    };
+
+    // Records GLFW input with its frame index into a compact binary trace and
+    // plays it back frame by frame with a fixed timestep, turning a recorded
+    // session into a repeatable workload.
+    //
+    // Trace layout (little endian): "VINP", u16 version, u16 reserved,
+    // f32 timestep, then per record: u32 frame, f32 time, u8 type and a
+    // type-specific payload.
+    class InputRecorder {
+    public:
+        static constexpr float DefaultTimestep = 1.0f / 60.0f;
+
+        bool startRecording(const std::filesystem::path& path, float fixedTimestep = DefaultTimestep);
+        void stopRecording();
+        bool startReplay(const std::filesystem::path& path);
+        void stopReplay();
+
+        bool isRecording() const { return m_Recording; }
+        bool isReplaying() const { return m_Replaying; }
+        bool isReplayFinished() const { return m_Replaying && m_Frame != UINT32_MAX && m_Cursor == m_Records.size() && m_Frame >= m_LastFrame; }
+
+        void beginFrame(double time);
+        void record(InputRecord record);
+        // Records captured during this frame's poll, in order (replay only).
+        std::span<const InputRecord> getFrameRecords() const;
+
+        float getFixedTimestep() const { return m_FixedTimestep; }
+        uint32_t getFrame() const { return m_Frame; }
+    private:
+        std::ofstream m_File;
+        std::vector<InputRecord> m_Records;
+        size_t m_Cursor = 0, m_FrameBegin = 0;
+        uint32_t m_Frame = 0, m_LastFrame = 0;
+        double m_StartTime = -1.0, m_Time = 0.0;
+        float m_FixedTimestep = DefaultTimestep;
+        bool m_Recording = false;
+        bool m_Replaying = false;
+    };
+
+} // namespace vica
@@ -0,0 +1,152 @@
+#include "profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <print>
+#include <vector>
+
+#include "base.h"
+
+namespace vica {
+
+    namespace {
+        struct Record {
+            const char* name;
+            uint64_t timestamp; // ns since s_Epoch
+            bool begin;
+        };
+
+        // Written only by the owning thread. count is published with release
+        // so flush() can read records[0, count) while the owner keeps
+        // appending; once next is set the owner never touches the chunk again.
+        struct Chunk {
+            static constexpr uint32_t Capacity = 4096;
+
+            std::atomic<uint32_t> count{ 0 };
+            std::atomic<Chunk*> next{ nullptr };
+            Record records[Capacity];
+        };
+
+        struct ThreadBuffer {
+            uint32_t threadId;
+            std::string name;
+            Chunk* tail;     // owner
+            Chunk* head;     // flush()
+            uint32_t read = 0; // flush(), records of head already written
+        };
+
+        const auto s_Epoch = std::chrono::steady_clock::now();
+
+        std::mutex s_Mutex; // registration, thread names and flush()
+        std::vector<Scope<ThreadBuffer>> s_Buffers;
+
+        ThreadBuffer* registerThread() {
+            auto buffer = CreateScope<ThreadBuffer>();
+            buffer->tail = buffer->head = new Chunk();
+
+            std::lock_guard lock(s_Mutex);
+            buffer->threadId = (uint32_t)s_Buffers.size() + 1;
+            buffer->name = std::format("Thread {}", buffer->threadId);
+            return s_Buffers.emplace_back(std::move(buffer)).get();
+        }
+
+        ThreadBuffer* getThreadBuffer() {
+            // Buffers outlive their threads so a flush after join still sees them.
+            thread_local ThreadBuffer* t_Buffer = registerThread();
+            return t_Buffer;
+        }
+
+        void append(const char* name, bool begin) {
+            uint64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count();
+
+            ThreadBuffer* buffer = getThreadBuffer();
+            Chunk* chunk = buffer->tail;
+            uint32_t count = chunk->count.load(std::memory_order_relaxed);
+            if (count == Chunk::Capacity) {
+                Chunk* next = new Chunk();
+                chunk->next.store(next, std::memory_order_release);
+                buffer->tail = chunk = next;
+                count = 0;
+            }
+
+            chunk->records[count] = { name, timestamp, begin };
+            chunk->count.store(count + 1, std::memory_order_release);
+        }
+
+        void appendEscaped(std::string& out, const char* text) {
+            for (; *text; text++) {
+                if (*text == '"' || *text == '\\')
+                    out += '\\';
+                out += *text;
+            }
+        }
+    }
+
+    void Profiler::begin(const char* name) {
+        append(name, true);
+    }
+
+    void Profiler::end(const char* name) {
+        append(name, false);
+    }
+
+    void Profiler::setThreadName(std::string name) {
+        if (!isEnabled())
+            return;
+        ThreadBuffer* buffer = getThreadBuffer();
+        std::lock_guard lock(s_Mutex);
+        buffer->name = std::move(name);
+    }
+
+    bool Profiler::flush(const std::filesystem::path& path) {
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        size_t eventCount = 0;
+        {
+            std::lock_guard lock(s_Mutex);
+            for (auto& buffer : s_Buffers) {
+                json += "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,";
+                std::format_to(std::back_inserter(json), "\"tid\":{},\"args\":{{\"name\":\"", buffer->threadId);
+                appendEscaped(json, buffer->name.c_str());
+                json += "\"}},";
+
+                while (true) {
+                    Chunk* chunk = buffer->head;
+                    uint32_t count = chunk->count.load(std::memory_order_acquire);
+                    for (uint32_t i = buffer->read; i < count; i++) {
+                        const Record& record = chunk->records[i];
+                        json += "\n{\"name\":\"";
+                        appendEscaped(json, record.name);
+                        std::format_to(std::back_inserter(json), "\",\"ph\":\"{}\",\"ts\":{:.3f},\"pid\":1,\"tid\":{}}},",
+                            record.begin ? 'B' : 'E', record.timestamp / 1000.0, buffer->threadId);
+                    }
+                    eventCount += count - buffer->read;
+                    buffer->read = count;
+
+                    Chunk* next = count == Chunk::Capacity ? chunk->next.load(std::memory_order_acquire) : nullptr;
+                    if (!next)
+                        break;
+                    delete chunk;
+                    buffer->head = next;
+                    buffer->read = 0;
+                }
+            }
+        }
+        if (json.back() == ',')
+            json.pop_back();
+        json += "\n]}\n";
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::println("Failed to write trace: {}", path.string());
+            return false;
+        }
+        file << json;
+        std::println("Wrote {} trace events to {}", eventCount, path.string());
+        return true;
+    }
+
+} // namespace vica
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Scoped CPU tracing. Compiled in only with VICA_PROFILE
+// (cmake -DVICA_PROFILE=ON); without it the macros expand to nothing.
+//
+// Every thread appends begin/end records to its own chunked buffer, so
+// recording takes no lock. flush() writes everything recorded since the
+// previous flush as Chrome trace-event JSON, which opens in Perfetto
+// (ui.perfetto.dev) or chrome://tracing.
+
+namespace vica {
+    class Profiler {
+    public:
+        static constexpr bool isEnabled() {
+#ifdef VICA_PROFILE
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // name must outlive the trace (string literals, __func__).
+        static void begin(const char* name);
+        static void end(const char* name);
+
+        // Label for the calling thread in the trace.
+        static void setThreadName(std::string name);
+
+        static bool flush(const std::filesystem::path& path);
+    };
+
+    class ProfileScope {
+    public:
+        ProfileScope(const char* name) : m_Name(name) { Profiler::begin(name); }
+        ~ProfileScope() { Profiler::end(m_Name); }
+    private:
+        const char* m_Name;
+    };
+
+} // namespace vica
+
+#define VICA_PROFILE_CONCAT_IMPL(a, b) a##b
+#define VICA_PROFILE_CONCAT(a, b) VICA_PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(_MSC_VER)
+#define VICA_FUNC_SIG __FUNCSIG__
+#else
+#define VICA_FUNC_SIG __PRETTY_FUNCTION__
+#endif
+
+#ifdef VICA_PROFILE
+#define VICA_PROFILE_SCOPE(name) ::vica::ProfileScope VICA_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define VICA_PROFILE_FUNCTION() VICA_PROFILE_SCOPE(VICA_FUNC_SIG)
+#else
+#define VICA_PROFILE_SCOPE(name)
+#define VICA_PROFILE_FUNCTION()
+#endif
@@ -0,0 +1,157 @@
+#include "entityRegistry.h"
+
+#include <chrono>
+#include <format>
+#include <print>
+#include <random>
+
+namespace vica {
+
+    UUID EntityRegistry::create(UUID id) {
+        getOrCreateIndex(id);
+        return id;
+    }
+
+    uint32_t EntityRegistry::getOrCreateIndex(UUID id) {
+        auto [it, inserted] = m_Lookup.try_emplace(id, 0);
+        if (!inserted)
+            return it->second;
+
+        if (!m_FreeIndices.empty()) {
+            it->second = m_FreeIndices.back();
+            m_FreeIndices.pop_back();
+            m_Entities[it->second] = id;
+        }
+        else {
+            it->second = (uint32_t)m_Entities.size();
+            m_Entities.push_back(id);
+        }
+        return it->second;
+    }
+
+    bool EntityRegistry::destroy(UUID id) {
+        auto it = m_Lookup.find(id);
+        if (it == m_Lookup.end())
+            return false;
+
+        for (const auto& pool : m_Pools)
+            if (pool)
+                pool->remove(it->second);
+
+        m_FreeIndices.push_back(it->second);
+        m_Lookup.erase(it);
+        return true;
+    }
+
+    void EntityRegistry::clear() {
+        m_Lookup.clear();
+        m_Entities.clear();
+        m_FreeIndices.clear();
+        m_Pools.clear();
+    }
+
+    namespace {
+        struct Transform {
+            float x = 0.0f, y = 0.0f, rotation = 0.0f;
+        };
+
+        struct Velocity {
+            float x = 0.0f, y = 0.0f, angular = 0.0f;
+        };
+
+        struct Tint {
+            uint32_t color = 0xFFFFFFFF;
+        };
+
+        // What scenes did before: one heap object per item behind a UUID map.
+        struct Object {
+            Transform transform;
+            Velocity velocity;
+            bool hasTint = false;
+            Tint tint;
+        };
+
+        void integrate(Transform& transform, const Velocity& velocity) {
+            transform.x += velocity.x * 0.016f;
+            transform.y += velocity.y * 0.016f;
+            transform.rotation += velocity.angular * 0.016f;
+        }
+
+        template<typename F>
+        double measure(uint32_t iterations, F&& func) {
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++)
+                func();
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+        }
+    }
+
+    void EntityRegistry::Benchmark(uint32_t entityCount) {
+        constexpr uint32_t Iterations = 50;
+        std::vector<UUID> ids(entityCount, UUID(0));
+        UUID::Generate(ids);
+
+        std::vector<UUID> lookups(ids);
+        std::shuffle(lookups.begin(), lookups.end(), std::mt19937_64(42));
+
+        ThreadPool pool;
+        float checksum = 0.0f;
+        auto perEntity = [entityCount](double seconds) { return seconds * 1e9 / entityCount; };
+
+        // Map of objects.
+        std::unordered_map<UUID, Scope<Object>> objects;
+        double mapCreate = measure(1, [&] {
+            for (uint32_t i = 0; i < entityCount; i++) {
+                Scope<Object> object = CreateScope<Object>();
+                object->velocity = { 1.0f, 2.0f, 0.5f };
+                object->hasTint = i % 4 == 0;
+                objects.emplace(ids[i], std::move(object));
+            }
+            });
+        double mapUpdate = measure(Iterations, [&] {
+            for (auto& [id, object] : objects)
+                integrate(object->transform, object->velocity);
+            });
+        double mapFiltered = measure(Iterations, [&] {
+            for (auto& [id, object] : objects)
+                if (object->hasTint)
+                    object->tint.color ^= (uint32_t)object->transform.x;
+            });
+        double mapLookup = measure(1, [&] {
+            for (UUID id : lookups)
+                checksum += objects.find(id)->second->transform.x;
+            });
+
+        // Sparse sets.
+        EntityRegistry registry;
+        double registryCreate = measure(1, [&] {
+            for (uint32_t i = 0; i < entityCount; i++) {
+                registry.emplace<Transform>(ids[i]);
+                registry.emplace<Velocity>(ids[i], 1.0f, 2.0f, 0.5f);
+                if (i % 4 == 0)
+                    registry.emplace<Tint>(ids[i]);
+            }
+            });
+        double registryUpdate = measure(Iterations, [&] {
+            registry.view<Transform, Velocity>().each(integrate);
+            });
+        double registryFiltered = measure(Iterations, [&] {
+            registry.view<Tint, Transform>().each([](Tint& tint, const Transform& transform) { tint.color ^= (uint32_t)transform.x; });
+            });
+        double registryParallel = measure(Iterations, [&] {
+            registry.view<Transform, Velocity>().parallelEach(pool, integrate);
+            });
+        double registryLookup = measure(1, [&] {
+            for (UUID id : lookups)
+                checksum += registry.tryGet<Transform>(id)->x;
+            });
+
+        std::println("{} entities, a quarter with Tint; ns per entity ({} worker threads), checksum {}", entityCount, pool.getThreadCount(), checksum);
+        std::println("{:<16} {:>10} {:>10} {:>10} {:>10} {:>10}", "storage", "create", "update", "tinted", "parallel", "lookup");
+        std::println("{:<16} {:>10.1f} {:>10.2f} {:>10.2f} {:>10} {:>10.1f}", "map of objects",
+            perEntity(mapCreate), perEntity(mapUpdate), perEntity(mapFiltered), "-", perEntity(mapLookup));
+        std::println("{:<16} {:>10.1f} {:>10.2f} {:>10.2f} {:>10.2f} {:>10.1f}", "sparse sets",
+            perEntity(registryCreate), perEntity(registryUpdate), perEntity(registryFiltered), perEntity(registryParallel), perEntity(registryLookup));
+    }
+
+} // namespace vica
@@ -0,0 +1,259 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <latch>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base.h"
+#include "threadPool.h"
+#include "uuid.h"
+
+namespace vica {
+
+    namespace detail {
+        inline uint32_t nextComponentTypeId() {
+            static std::atomic<uint32_t> next{ 0 };
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        template<typename T>
+        uint32_t getComponentTypeId() {
+            static const uint32_t id = nextComponentTypeId();
+            return id;
+        }
+    }
+
+    class ComponentPoolBase {
+    public:
+        static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+        virtual ~ComponentPoolBase() = default;
+        virtual bool remove(uint32_t entity) = 0;
+
+        bool contains(uint32_t entity) const {
+            return entity < m_Sparse.size() && m_Sparse[entity] != InvalidIndex;
+        }
+
+        uint32_t getDenseIndex(uint32_t entity) const { return m_Sparse[entity]; }
+        const std::vector<uint32_t>& getEntities() const { return m_Dense; }
+        size_t size() const { return m_Dense.size(); }
+    protected:
+        std::vector<uint32_t> m_Sparse; // entity index -> dense index
+        std::vector<uint32_t> m_Dense;  // dense index -> entity index
+    };
+
+    // Sparse set: components of one type are packed in m_Components, in the
+    // same order as m_Dense. Removal swaps the last component into the hole.
+    template<typename T>
+    class ComponentPool : public ComponentPoolBase {
+    public:
+        template<typename ... Args>
+        T& emplace(uint32_t entity, Args&& ... args) {
+            if (contains(entity))
+                return m_Components[m_Sparse[entity]] = T(std::forward<Args>(args)...);
+
+            if (entity >= m_Sparse.size())
+                m_Sparse.resize(entity + 1, InvalidIndex);
+            m_Sparse[entity] = (uint32_t)m_Dense.size();
+            m_Dense.push_back(entity);
+            return m_Components.emplace_back(std::forward<Args>(args)...);
+        }
+
+        bool remove(uint32_t entity) override {
+            if (!contains(entity))
+                return false;
+
+            uint32_t dense = m_Sparse[entity];
+            uint32_t last = (uint32_t)m_Dense.size() - 1;
+            if (dense != last) {
+                m_Components[dense] = std::move(m_Components[last]);
+                m_Dense[dense] = m_Dense[last];
+                m_Sparse[m_Dense[dense]] = dense;
+            }
+            m_Components.pop_back();
+            m_Dense.pop_back();
+            m_Sparse[entity] = InvalidIndex;
+            return true;
+        }
+
+        T& get(uint32_t entity) { return m_Components[m_Sparse[entity]]; }
+        T& getDense(uint32_t dense) { return m_Components[dense]; }
+    private:
+        std::vector<T> m_Components;
+    };
+
+    class EntityRegistry;
+
+    // Entities that have every one of Ts. Iteration walks the smallest pool's
+    // dense array and probes the others through their sparse arrays, so the
+    // cost is proportional to the rarest component, not to the entity count.
+    template<typename ... Ts>
+    class EntityView {
+    public:
+        EntityView(const EntityRegistry& registry, ComponentPool<Ts>* ... pools)
+            : m_Registry(registry), m_Pools(pools...) {
+            m_Driver = nullptr;
+            bool empty = false;
+            ((empty |= !pools), ...);
+            if (empty)
+                return;
+            ((m_Driver = !m_Driver || pools->size() < m_Driver->size() ? (ComponentPoolBase*)pools : m_Driver), ...);
+        }
+
+        // func(Ts&...) or func(UUID, Ts&...). Components may be modified but
+        // entities and components must not be added or removed meanwhile.
+        template<typename F>
+        void each(F&& func) const {
+            if (m_Driver)
+                eachInRange(func, 0, m_Driver->size());
+        }
+
+        // Splits the driving pool into chunks run on the thread pool; the
+        // calling thread takes the first chunk and returns once all are done.
+        // func runs concurrently, so it must only touch the entity it is given.
+        template<typename F>
+        void parallelEach(ThreadPool& pool, F&& func, size_t minChunkSize = 4096) const {
+            if (!m_Driver)
+                return;
+
+            size_t count = m_Driver->size();
+            size_t chunks = std::min<size_t>((size_t)pool.getThreadCount() * 4 + 1, (count + minChunkSize - 1) / std::max<size_t>(minChunkSize, 1));
+            if (chunks <= 1) {
+                eachInRange(func, 0, count);
+                return;
+            }
+
+            size_t chunkSize = (count + chunks - 1) / chunks;
+            std::latch done((std::ptrdiff_t)chunks - 1);
+            for (size_t chunk = 1; chunk < chunks; chunk++)
+                pool.enqueue([&, chunk] {
+                    eachInRange(func, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+                    done.count_down();
+                    });
+            eachInRange(func, 0, std::min(count, chunkSize));
+            done.wait();
+        }
+
+        size_t sizeHint() const { return m_Driver ? m_Driver->size() : 0; }
+    private:
+        template<typename F>
+        void eachInRange(F& func, size_t begin, size_t end) const;
+    private:
+        const EntityRegistry& m_Registry;
+        std::tuple<ComponentPool<Ts>*...> m_Pools;
+        ComponentPoolBase* m_Driver;
+    };
+
+    // Per-scene entity/component storage keyed by UUID. The UUID is resolved
+    // to a dense entity index once; components live in one packed array per
+    // type, so systems iterate arrays instead of chasing per-object pointers.
+    class EntityRegistry {
+    public:
+        EntityRegistry() = default;
+        EntityRegistry(const EntityRegistry&) = delete;
+        EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+        // Returns the existing entity if id is already registered. emplace()
+        // registers unknown ids itself.
+        UUID create(UUID id = UUID());
+        bool destroy(UUID id);
+        void clear();
+
+        bool isValid(UUID id) const { return m_Lookup.contains(id); }
+        size_t size() const { return m_Lookup.size(); }
+
+        template<typename T, typename ... Args>
+        T& emplace(UUID id, Args&& ... args) {
+            return getOrCreatePool<T>().emplace(getOrCreateIndex(id), std::forward<Args>(args)...);
+        }
+
+        template<typename T>
+        bool remove(UUID id) {
+            ComponentPool<T>* pool = getPool<T>();
+            auto it = m_Lookup.find(id);
+            return pool && it != m_Lookup.end() && pool->remove(it->second);
+        }
+
+        template<typename T>
+        T* tryGet(UUID id) {
+            ComponentPool<T>* pool = getPool<T>();
+            auto it = m_Lookup.find(id);
+            return pool && it != m_Lookup.end() && pool->contains(it->second) ? &pool->get(it->second) : nullptr;
+        }
+
+        template<typename T>
+        bool has(UUID id) const {
+            const ComponentPool<T>* pool = getPool<T>();
+            auto it = m_Lookup.find(id);
+            return pool && it != m_Lookup.end() && pool->contains(it->second);
+        }
+
+        template<typename ... Ts>
+        EntityView<Ts...> view() {
+            static_assert(sizeof...(Ts) > 0);
+            return EntityView<Ts...>(*this, getPool<Ts>()...);
+        }
+
+        UUID getUUID(uint32_t index) const { return m_Entities[index]; }
+
+        // Creates, updates and looks up entityCount entities in a registry and
+        // in an unordered_map of heap objects, and prints both timings.
+        static void Benchmark(uint32_t entityCount = 100000);
+    private:
+        uint32_t getOrCreateIndex(UUID id);
+
+        template<typename T>
+        ComponentPool<T>* getPool() const {
+            uint32_t type = detail::getComponentTypeId<T>();
+            return type < m_Pools.size() ? (ComponentPool<T>*)m_Pools[type].get() : nullptr;
+        }
+
+        template<typename T>
+        ComponentPool<T>& getOrCreatePool() {
+            uint32_t type = detail::getComponentTypeId<T>();
+            if (type >= m_Pools.size())
+                m_Pools.resize(type + 1);
+            if (!m_Pools[type])
+                m_Pools[type] = CreateScope<ComponentPool<T>>();
+            return *(ComponentPool<T>*)m_Pools[type].get();
+        }
+    private:
+        std::unordered_map<UUID, uint32_t> m_Lookup;
+        std::vector<UUID> m_Entities;       // entity index -> UUID
+        std::vector<uint32_t> m_FreeIndices;
+        std::vector<Scope<ComponentPoolBase>> m_Pools; // indexed by component type id
+    };
+
+    template<typename ... Ts>
+    template<typename F>
+    void EntityView<Ts...>::eachInRange(F& func, size_t begin, size_t end) const {
+        const std::vector<uint32_t>& entities = m_Driver->getEntities();
+        for (size_t i = begin; i < end; i++) {
+            uint32_t entity = entities[i];
+            if constexpr (sizeof...(Ts) == 1) {
+                // Single component: a straight walk over the packed array.
+                auto& component = std::get<0>(m_Pools)->getDense((uint32_t)i);
+                if constexpr (std::is_invocable_v<F&, UUID, Ts&...>)
+                    func(m_Registry.getUUID(entity), component);
+                else
+                    func(component);
+            }
+            else {
+                if (!std::apply([entity](auto* ... pools) { return (pools->contains(entity) && ...); }, m_Pools))
+                    continue;
+                std::apply([&](auto* ... pools) {
+                    if constexpr (std::is_invocable_v<F&, UUID, Ts&...>)
+                        func(m_Registry.getUUID(entity), pools->get(entity)...);
+                    else
+                        func(pools->get(entity)...);
+                    }, m_Pools);
+            }
+        }
+    }
+
+} // namespace vica
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace vica {
+    class ThreadPool;
+
+    enum class FileReadBackend {
+        Auto,       // io_uring when compiled in and permitted, otherwise ThreadPool
+        IoUring,
+        ThreadPool, // one pread() task per file
+    };
+
+    struct FileReadResult {
+        std::vector<uint8_t> data;
+        bool ok = false;
+    };
+
+    // Reads many files at once so the disk sees a deep queue instead of one
+    // request at a time. With io_uring up to queueDepth files are open and
+    // being read at once; the fallback issues them from the thread pool.
+    class FileReader {
+    public:
+        // Results are in the order of paths.
+        static std::vector<FileReadResult> ReadAll(std::span<const std::filesystem::path> paths, ThreadPool& pool,
+            FileReadBackend backend = FileReadBackend::Auto, uint32_t queueDepth = 64);
+
+        static bool IsIoUringAvailable();
+        static const char* GetBackendName(FileReadBackend backend);
+
+        // Cold-cache startup benchmark: fills directory with a synthetic tree
+        // if it does not exist, then times ReadAll over it per backend after
+        // evicting the files from the page cache.
+        static void Benchmark(const std::filesystem::path& directory, uint32_t fileCount = 2000);
+    };
+
+    std::vector<uint8_t> readFileBytes(const std::filesystem::path& path);
+
+} // namespace vica
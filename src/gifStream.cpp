@@ -0,0 +1,348 @@
+#include "gifStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <utility>
+
+namespace vica {
+
+    namespace {
+        constexpr uint32_t MaxCodes = 4096;
+
+        struct FrameRect {
+            uint32_t left = 0, top = 0, width = 0, height = 0;
+        };
+
+        // Little-endian reader over the file; every read is bounds checked.
+        class Reader {
+        public:
+            Reader(std::span<const uint8_t> data, size_t position = 0) : m_Data(data), m_Position(position) {}
+
+            bool read(uint8_t& value) {
+                if (m_Position >= m_Data.size())
+                    return false;
+                value = m_Data[m_Position++];
+                return true;
+            }
+
+            bool read(uint16_t& value) {
+                if (m_Data.size() - std::min(m_Position, m_Data.size()) < 2)
+                    return false;
+                value = (uint16_t)(m_Data[m_Position] | (m_Data[m_Position + 1] << 8));
+                m_Position += 2;
+                return true;
+            }
+
+            const uint8_t* take(size_t size) {
+                if (m_Data.size() - std::min(m_Position, m_Data.size()) < size)
+                    return nullptr;
+                const uint8_t* bytes = m_Data.data() + m_Position;
+                m_Position += size;
+                return bytes;
+            }
+
+            // Skips a chain of data sub-blocks up to and including its terminator.
+            bool skipSubBlocks() {
+                uint8_t size;
+                while (read(size) && size)
+                    if (!take(size))
+                        return false;
+                return m_Position <= m_Data.size();
+            }
+
+            size_t getPosition() const { return m_Position; }
+        private:
+            std::span<const uint8_t> m_Data;
+            size_t m_Position;
+        };
+
+        // Reads LZW codes of a variable width out of the image's sub-blocks.
+        class CodeReader {
+        public:
+            CodeReader(Reader& reader) : m_Reader(reader) {}
+
+            bool read(uint32_t width, uint32_t& code) {
+                while (m_BitCount < width) {
+                    if (!m_BlockRemaining) {
+                        uint8_t size;
+                        if (m_Ended || !m_Reader.read(size) || !size) {
+                            m_Ended = true;
+                            return false;
+                        }
+                        m_BlockRemaining = size;
+                    }
+                    uint8_t byte;
+                    if (!m_Reader.read(byte))
+                        return false;
+                    m_BlockRemaining--;
+                    m_Bits |= (uint32_t)byte << m_BitCount;
+                    m_BitCount += 8;
+                }
+                code = m_Bits & ((1u << width) - 1);
+                m_Bits >>= width;
+                m_BitCount -= width;
+                return true;
+            }
+
+            // Moves the reader past the rest of the image data.
+            void finish() {
+                if (m_Ended)
+                    return;
+                if (m_BlockRemaining)
+                    m_Reader.take(m_BlockRemaining);
+                m_Reader.skipSubBlocks();
+            }
+        private:
+            Reader& m_Reader;
+            uint32_t m_Bits = 0, m_BitCount = 0;
+            uint32_t m_BlockRemaining = 0;
+            bool m_Ended = false;
+        };
+    }
+
+    struct GifStream::State {
+        std::vector<uint8_t> data;
+        size_t firstBlock = 0; // right after the header and global palette
+        size_t position = 0;
+
+        // Full 256-entry palettes, so out-of-range indices read black.
+        uint8_t globalPalette[256 * 3] = {};
+        uint8_t localPalette[256 * 3] = {};
+        bool hasGlobalPalette = false;
+
+        std::vector<uint8_t> canvas;  // RGBA8, what has been shown so far
+        std::vector<uint8_t> restore; // canvas before the last frame, for "restore to previous"
+        uint32_t lastDisposal = 0;
+        FrameRect lastRect;
+
+        // LZW string table: each code is its prefix code plus one index.
+        uint16_t prefix[MaxCodes] = {};
+        uint8_t suffix[MaxCodes] = {};
+        uint8_t first[MaxCodes] = {};
+        uint8_t stack[MaxCodes] = {};
+
+        uint32_t width = 0, height = 0;
+
+        // Draws one image's pixels into the canvas.
+        void decodeImage(Reader& reader, const FrameRect& rect, bool interlaced, const uint8_t* palette, int32_t transparent);
+
+        void reset() {
+            position = firstBlock;
+            std::fill(canvas.begin(), canvas.end(), 0);
+            lastDisposal = 0;
+            lastRect = {};
+        }
+    };
+
+    GifStream::GifStream(std::vector<uint8_t> data)
+        : m_State(CreateScope<State>()) {
+        Reader reader(data);
+        const uint8_t* signature = reader.take(6);
+        uint16_t width, height;
+        uint8_t flags, background, aspect;
+        if (!signature || (std::memcmp(signature, "GIF87a", 6) && std::memcmp(signature, "GIF89a", 6))
+            || !reader.read(width) || !reader.read(height) || !reader.read(flags) || !reader.read(background) || !reader.read(aspect)
+            || !width || !height)
+            return;
+
+        State& state = *m_State;
+        if (flags & 0x80) {
+            size_t size = (size_t)3 << ((flags & 7) + 1);
+            const uint8_t* palette = reader.take(size);
+            if (!palette)
+                return;
+            std::memcpy(state.globalPalette, palette, size);
+            state.hasGlobalPalette = true;
+        }
+
+        m_Width = state.width = width;
+        m_Height = state.height = height;
+        state.firstBlock = reader.getPosition();
+        state.data = std::move(data);
+        state.canvas.resize((size_t)m_Width * m_Height * 4);
+        state.reset();
+    }
+
+    GifStream::~GifStream() = default;
+
+    void GifStream::State::decodeImage(Reader& reader, const FrameRect& rect, bool interlaced, const uint8_t* palette, int32_t transparent) {
+        uint8_t minimumCodeSize;
+        if (!reader.read(minimumCodeSize))
+            return;
+        if (minimumCodeSize < 1 || minimumCodeSize > 8) {
+            reader.skipSubBlocks();
+            return;
+        }
+
+        // Pixels arrive in row order, or in four interlaced passes.
+        static constexpr uint32_t PassStart[] = { 0, 4, 2, 1 };
+        static constexpr uint32_t PassStep[] = { 8, 8, 4, 2 };
+        uint32_t pass = 0, row = 0, column = 0;
+        size_t remaining = (size_t)rect.width * rect.height;
+
+        auto emit = [&](uint8_t index) {
+            uint32_t x = rect.left + column, y = rect.top + row;
+            if ((int32_t)index != transparent && x < width && y < height) {
+                uint8_t* pixel = canvas.data() + ((size_t)y * width + x) * 4;
+                pixel[0] = palette[index * 3 + 0];
+                pixel[1] = palette[index * 3 + 1];
+                pixel[2] = palette[index * 3 + 2];
+                pixel[3] = 255;
+            }
+            remaining--;
+            if (++column < rect.width)
+                return;
+            column = 0;
+            row += interlaced ? PassStep[pass] : 1;
+            while (interlaced && row >= rect.height && ++pass < 4)
+                row = PassStart[pass];
+        };
+
+        const uint32_t clear = 1u << minimumCodeSize, end = clear + 1;
+        for (uint32_t code = 0; code < clear; code++) {
+            suffix[code] = (uint8_t)code;
+            first[code] = (uint8_t)code;
+        }
+
+        CodeReader codes(reader);
+        uint32_t codeSize = minimumCodeSize + 1, nextCode = clear + 2;
+        int32_t previous = -1;
+        uint32_t code;
+        while (remaining && codes.read(codeSize, code)) {
+            if (code == clear) {
+                codeSize = minimumCodeSize + 1;
+                nextCode = clear + 2;
+                previous = -1;
+                continue;
+            }
+            if (code == end)
+                break;
+
+            if (previous < 0) {
+                if (code >= clear)
+                    break;
+                emit((uint8_t)code);
+                previous = (int32_t)code;
+                continue;
+            }
+
+            // The code not yet in the table (KwKwK case) is the previous string plus its own first index.
+            if (code > nextCode || (code == nextCode && nextCode >= MaxCodes))
+                break;
+            uint8_t head = code < nextCode ? first[code] : first[previous];
+            if (nextCode < MaxCodes) {
+                prefix[nextCode] = (uint16_t)previous;
+                suffix[nextCode] = head;
+                first[nextCode] = first[previous];
+                nextCode++;
+                if (nextCode == (1u << codeSize) && codeSize < 12)
+                    codeSize++;
+            }
+
+            uint32_t depth = 0;
+            for (uint32_t c = code; ; c = prefix[c]) {
+                stack[depth++] = suffix[c];
+                if (c < clear)
+                    break;
+            }
+            while (depth && remaining)
+                emit(stack[--depth]);
+            previous = (int32_t)code;
+        }
+        codes.finish();
+    }
+
+    bool GifStream::next(uint8_t* dst, uint32_t& delayMilliseconds) {
+        if (!isValid())
+            return false;
+
+        State& state = *m_State;
+        Reader reader(state.data, state.position);
+        uint32_t disposal = 0, delay = 0;
+        int32_t transparent = -1;
+
+        for (;;) {
+            uint8_t block;
+            if (!reader.read(block) || block == 0x3B) // end of data or trailer
+                return false;
+
+            if (block == 0x21) {
+                uint8_t label;
+                if (!reader.read(label))
+                    return false;
+                if (label == 0xF9) {
+                    // Graphic control extension: applies to the next image only.
+                    uint8_t size, flags, index;
+                    uint16_t centiseconds;
+                    if (!reader.read(size) || size < 4 || !reader.read(flags) || !reader.read(centiseconds) || !reader.read(index)
+                        || !reader.take(size - 4))
+                        return false;
+                    disposal = (flags >> 2) & 7;
+                    transparent = (flags & 1) ? index : -1;
+                    delay = centiseconds * 10u;
+                }
+                if (!reader.skipSubBlocks())
+                    return false;
+                continue;
+            }
+
+            if (block != 0x2C)
+                return false;
+
+            FrameRect rect;
+            uint16_t left, top, width, height;
+            uint8_t flags;
+            if (!reader.read(left) || !reader.read(top) || !reader.read(width) || !reader.read(height) || !reader.read(flags))
+                return false;
+            rect = { left, top, width, height };
+
+            const uint8_t* palette = state.hasGlobalPalette ? state.globalPalette : nullptr;
+            if (flags & 0x80) {
+                size_t size = (size_t)3 << ((flags & 7) + 1);
+                const uint8_t* local = reader.take(size);
+                if (!local)
+                    return false;
+                std::memset(state.localPalette, 0, sizeof(state.localPalette));
+                std::memcpy(state.localPalette, local, size);
+                palette = state.localPalette;
+            }
+            if (!palette)
+                return false;
+
+            // Undo the previous frame as its disposal method asks.
+            auto forEachRow = [&](const FrameRect& r, auto&& func) {
+                uint32_t x0 = std::min(r.left, m_Width), x1 = std::min(r.left + r.width, m_Width);
+                for (uint32_t y = r.top; y < std::min(r.top + r.height, m_Height); y++)
+                    if (x1 > x0)
+                        func((size_t)(y * m_Width + x0) * 4, (size_t)(x1 - x0) * 4);
+            };
+            if (state.lastDisposal == 2)
+                forEachRow(state.lastRect, [&](size_t offset, size_t size) { std::memset(state.canvas.data() + offset, 0, size); });
+            else if (state.lastDisposal == 3 && !state.restore.empty())
+                forEachRow(state.lastRect, [&](size_t offset, size_t size) { std::memcpy(state.canvas.data() + offset, state.restore.data() + offset, size); });
+            if (disposal == 3)
+                state.restore = state.canvas;
+
+            state.decodeImage(reader, rect, (flags & 0x40) != 0, palette, transparent);
+
+            state.lastDisposal = disposal;
+            state.lastRect = rect;
+            state.position = reader.getPosition();
+
+            std::memcpy(dst, state.canvas.data(), state.canvas.size());
+            delayMilliseconds = delay;
+            return true;
+        }
+    }
+
+    void GifStream::rewind() {
+        if (isValid())
+            m_State->reset();
+    }
+
+    size_t GifStream::getMemorySize() const {
+        return m_State->data.capacity() + m_State->canvas.capacity() + m_State->restore.capacity();
+    }
+
+} // namespace vica
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "base.h"
+
+namespace vica {
+    // Frame-at-a-time GIF decoder over an in-memory file. Unlike
+    // stbi_load_gif_from_memory it never holds more than the composited
+    // canvas, plus one copy of it for "restore to previous" disposal.
+    class GifStream {
+    public:
+        GifStream(std::vector<uint8_t> data);
+        ~GifStream();
+
+        GifStream(const GifStream&) = delete;
+        GifStream& operator=(const GifStream&) = delete;
+
+        bool isValid() const { return m_Width && m_Height; }
+        uint32_t getWidth() const { return m_Width; }
+        uint32_t getHeight() const { return m_Height; }
+
+        // Decodes the next frame as RGBA8 into dst (width * height * 4 bytes).
+        // Returns false after the last frame (or on error); rewind() to loop.
+        bool next(uint8_t* dst, uint32_t& delayMilliseconds);
+        void rewind();
+
+        // File bytes, canvas and the "restore to previous" copy, if any.
+        size_t getMemorySize() const;
+    private:
+        struct State;
+        Scope<State> m_State;
+        uint32_t m_Width = 0, m_Height = 0;
+    };
+
+} // namespace vica
@@ -0,0 +1,93 @@
+#include "halfFloat.h"
+
+#include <algorithm>
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VICA_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define VICA_TARGET_F16C
+#else
+#define VICA_TARGET_F16C __attribute__((target("avx,f16c")))
+#endif
+#endif
+
+namespace vica {
+
+    namespace {
+#ifdef VICA_X86
+        VICA_TARGET_F16C void convertF16C(const float* src, uint16_t* dst, size_t count) {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+                _mm_storeu_si128((__m128i*)(dst + i), half);
+            }
+            for (; i < count; i++)
+                dst[i] = floatToHalf(src[i]);
+        }
+#endif
+    }
+
+    bool hasF16C() {
+#if defined(VICA_X86) && defined(_MSC_VER)
+        static const bool supported = [] {
+            int info[4];
+            __cpuid(info, 1);
+            bool osxsave = info[2] & (1 << 27), avx = info[2] & (1 << 28), f16c = info[2] & (1 << 29);
+            return osxsave && avx && f16c && (_xgetbv(0) & 6) == 6;
+        }();
+        return supported;
+#elif defined(VICA_X86)
+        static const bool supported = __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+    uint16_t floatToHalf(float value) {
+        uint32_t bits = std::bit_cast<uint32_t>(value);
+        uint32_t sign = bits & 0x80000000u;
+        bits ^= sign;
+
+        uint32_t half;
+        if (bits >= 0x47800000u) // Inf, NaN or too large
+            half = bits > 0x7F800000u ? 0x7E00 : 0x7C00;
+        else if (bits < 0x38800000u) {
+            // Subnormal or zero: let the FPU's round-to-nearest-even align
+            // the 10 mantissa bits at the bottom.
+            constexpr uint32_t magic = 126u << 23;
+            half = std::bit_cast<uint32_t>(std::bit_cast<float>(bits) + std::bit_cast<float>(magic)) - magic;
+        }
+        else {
+            uint32_t odd = (bits >> 13) & 1;
+            bits += ((uint32_t)(15 - 127) << 23) + 0xFFF + odd;
+            half = bits >> 13;
+        }
+        return (uint16_t)(half | (sign >> 16));
+    }
+
+    void convertFloatToHalf(const float* src, uint16_t* dst, size_t count) {
+#ifdef VICA_X86
+        if (hasF16C())
+            return convertF16C(src, dst, count);
+#endif
+        for (size_t i = 0; i < count; i++)
+            dst[i] = floatToHalf(src[i]);
+    }
+
+    void convertUnorm16ToHalf(const uint16_t* src, uint16_t* dst, size_t count) {
+        constexpr size_t ChunkSize = 1024;
+        float floats[ChunkSize];
+
+        for (size_t offset = 0; offset < count; offset += ChunkSize) {
+            size_t n = std::min(ChunkSize, count - offset);
+            for (size_t i = 0; i < n; i++)
+                floats[i] = src[offset + i] * (1.0f / 65535.0f);
+            convertFloatToHalf(floats, dst + offset, n);
+        }
+    }
+
+} // namespace vica
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace vica {
+    // IEEE 754 binary16 conversion, round to nearest even. Uses F16C when the
+    // CPU supports it (checked once at runtime), a scalar path otherwise.
+    bool hasF16C();
+
+    uint16_t floatToHalf(float value);
+    void convertFloatToHalf(const float* src, uint16_t* dst, size_t count);
+    // Maps [0, 65535] to [0, 1]. src and dst may be the same buffer.
+    void convertUnorm16ToHalf(const uint16_t* src, uint16_t* dst, size_t count);
+
+} // namespace vica
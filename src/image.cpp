@@ -1,52 +1,146 @@
 #include "image.h"
 #include <glad/glad.h>
-#define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include <print>
+#include <span>
+#include <vector>
+#include <cstring>
+#include <bit>
 
-vica::Image::Image(const std::filesystem::path& path) :m_Path(path), m_Name(path.filename().string().c_str()) {
-    int width, height, channels;
-    stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+#include "application.h"
+#include "debug/profiler.h"
+#include "imageDecoder.h"
+#include "fileReader.h"
 
-    if (!data)
-        std::println("Failed to load image {}, {}", path.string(), stbi_failure_reason());
+namespace {
+    // JPEG files usually carry a small JPEG thumbnail in IFD1 of their EXIF
+    // (APP1) segment, which always sits within the first 64 KiB.
+    std::vector<uint8_t> readExifThumbnail(std::span<const uint8_t> file) {
+        std::span<const uint8_t> head = file.first(std::min<size_t>(file.size(), 128 * 1024));
+        size_t size = head.size();
+        if (size < 4 || head[0] != 0xFF || head[1] != 0xD8)
+            return {};
 
-    m_Width = width;
-    m_Height = height;
+        size_t pos = 2;
+        while (pos + 4 <= size && head[pos] == 0xFF) {
+            uint8_t marker = head[pos + 1];
+            size_t length = (head[pos + 2] << 8) | head[pos + 3];
+            if (marker == 0xDA || marker == 0xD9)
+                break;
 
-    GLenum internalFormat = 0, dataFormat = 0;
-    switch (channels) {
-    case 4: internalFormat = GL_RGBA8; dataFormat = GL_RGBA; break;
-    case 3: internalFormat = GL_RGB8;  dataFormat = GL_RGB;  break;
+            if (marker == 0xE1 && length >= 16 && pos + 2 + length <= size && std::memcmp(&head[pos + 4], "Exif\0\0", 6) == 0) {
+                const uint8_t* tiff = &head[pos + 10];
+                size_t tiffSize = length - 8;
+                bool little = tiff[0] == 'I';
+
+                auto read16 = [&](size_t offset) -> uint32_t {
+                    return little ? tiff[offset] | (tiff[offset + 1] << 8) : (tiff[offset] << 8) | tiff[offset + 1];
+                };
+                auto read32 = [&](size_t offset) -> uint32_t {
+                    return little ? read16(offset) | (read16(offset + 2) << 16) : (read16(offset) << 16) | read16(offset + 2);
+                };
+
+                size_t ifd0 = read32(4);
+                if (ifd0 + 2 > tiffSize)
+                    return {};
+                size_t next = ifd0 + 2 + read16(ifd0) * 12;
+                if (next + 4 > tiffSize)
+                    return {};
+                size_t ifd1 = read32(next);
+                if (!ifd1 || ifd1 + 2 > tiffSize)
+                    return {};
+
+                size_t offset = 0, thumbnailSize = 0;
+                uint32_t entries = read16(ifd1);
+                for (uint32_t i = 0; i < entries && ifd1 + 2 + (i + 1) * 12 <= tiffSize; i++) {
+                    size_t entry = ifd1 + 2 + i * 12;
+                    switch (read16(entry)) {
+                    case 0x0201: offset = read32(entry + 8); break;
+                    case 0x0202: thumbnailSize = read32(entry + 8); break;
+                    }
+                }
+
+                if (!offset || !thumbnailSize || offset + thumbnailSize > tiffSize)
+                    return {};
+                return std::vector<uint8_t>(tiff + offset, tiff + offset + thumbnailSize);
+            }
+            pos += 2 + length;
+        }
+        return {};
     }
+}
+
+std::atomic<size_t> vica::Image::s_TextureMemory = 0;
 
-    if (!internalFormat & dataFormat)
-        std::println("Format not supported");
+vica::Image::Image(const std::filesystem::path& path)
+    : Image(path, vica::readFileBytes(path)) {
+}
+
+vica::Image::Image(const std::filesystem::path& path, std::span<const uint8_t> file)
+    : m_Path(path), m_Name(path.filename().string()), m_Width(0), m_Height(0), m_InternalFormat(0), m_DataFormat(0), m_DataType(0), m_ImageID(0) {
+    VICA_PROFILE_FUNCTION();
+    vica::ImageDecoder& decoder = vica::ImageDecoder::Select(file);
+
+    vica::ImageInfo info;
+    if (!decoder.readInfo(file, info)) {
+        std::println("Failed to load image {} with {}", path.string(), decoder.getName());
+        return;
+    }
 
-    m_InternalFormat = internalFormat;
-    m_DataFormat = dataFormat;
+    // .hdr and 16-bit sources keep their range as half floats; 32-bit floats would double the memory again.
+    bool highPrecision = info.isHighPrecision();
+    uint32_t channels = highPrecision || info.channels == 4 || info.channels == 2 ? 4 : 3;
+    m_Width = info.width;
+    m_Height = info.height;
+    m_InternalFormat = highPrecision ? GL_RGBA16F : channels == 4 ? GL_RGBA8 : GL_RGB8;
+    m_DataFormat = channels == 4 ? GL_RGBA : GL_RGB;
+    m_DataType = highPrecision ? GL_HALF_FLOAT : GL_UNSIGNED_BYTE;
 
-    glCreateTextures(GL_TEXTURE_2D, 1, &m_ImageID);
-    glTextureStorage2D(m_ImageID, 1, internalFormat, m_Width, m_Height);
+    m_ImageID = Application::Get().getTexturePool().acquire(getTextureDesc());
 
     glTextureParameteri(m_ImageID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTextureParameteri(m_ImageID, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
     glTextureParameteri(m_ImageID, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTextureParameteri(m_ImageID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    trackMemory();
+
+    // Decode straight into a mapped staging buffer and upload from there.
+    size_t size = (size_t)m_Width * m_Height * channels * (highPrecision ? sizeof(uint16_t) : 1);
+    GLuint staging;
+    glCreateBuffers(1, &staging);
+    glNamedBufferStorage(staging, size, nullptr, GL_MAP_WRITE_BIT);
+    void* pixels = glMapNamedBufferRange(staging, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
 
-    glTextureSubImage2D(m_ImageID, 0, 0, 0, m_Width, m_Height, dataFormat, GL_UNSIGNED_BYTE, data);
-    //glGenerateTextureMipmap(m_ImageID);
+    bool decoded;
+    {
+        VICA_PROFILE_SCOPE("ImageDecoder::decode");
+        decoded = highPrecision
+            ? decoder.decodeHalf(file, info, { (uint16_t*)pixels, size / sizeof(uint16_t) })
+            : decoder.decode(file, info, { (uint8_t*)pixels, size }, channels);
+    }
+    glUnmapNamedBuffer(staging);
 
-    stbi_image_free(data);
+    if (!decoded)
+        std::println("Failed to decode image {} with {}", path.string(), decoder.getName());
+    else {
+        VICA_PROFILE_SCOPE("glTextureSubImage2D");
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTextureSubImage2D(m_ImageID, 0, 0, 0, m_Width, m_Height, m_DataFormat, m_DataType, nullptr);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &staging);
 }
 
 vica::Image::Image(const char* name, void* data, const uint32_t size, const uint32_t width, const uint32_t height) : m_Name(name), m_Width(width), m_Height(height) {
+    VICA_PROFILE_FUNCTION();
     m_InternalFormat = GL_RGBA8;
     m_DataFormat = GL_RGBA;
+    m_DataType = GL_UNSIGNED_BYTE;
 
-    glCreateTextures(GL_TEXTURE_2D, 1, &m_ImageID);
-    glTextureStorage2D(m_ImageID, 1, m_InternalFormat, m_Width, m_Height);
+    m_ImageID = Application::Get().getTexturePool().acquire(getTextureDesc());
 
     //glTextureParameteri(m_ImageID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTextureParameteri(m_ImageID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -54,6 +148,7 @@ vica::Image::Image(const char* name, void* data, const uint32_t size, const uint
 
     glTextureParameteri(m_ImageID, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTextureParameteri(m_ImageID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    trackMemory();
 
     if (size != m_Width * m_Height * (m_DataFormat == GL_RGBA ? 4 : 3))
         std::println("Data size does not match image size");
@@ -61,8 +156,134 @@ vica::Image::Image(const char* name, void* data, const uint32_t size, const uint
 }
 
 
+vica::Image::Image(const std::filesystem::path& path, uint32_t width, uint32_t height, bool highPrecision)
+    : m_Path(path), m_Name(path.filename().string()), m_Width(width), m_Height(height),
+    m_InternalFormat(highPrecision ? GL_RGBA16F : GL_RGBA8), m_DataFormat(GL_RGBA), m_DataType(highPrecision ? GL_HALF_FLOAT : GL_UNSIGNED_BYTE),
+    m_ImageID(0), m_Loaded(false) {
+}
+
+Ref<vica::Image> vica::Image::CreateProgressive(const std::filesystem::path& path) {
+    return CreateProgressive(path, readFileBytes(path));
+}
+
+Ref<vica::Image> vica::Image::CreateProgressive(const std::filesystem::path& path, std::vector<uint8_t> fileData) {
+    VICA_PROFILE_FUNCTION();
+    auto file = CreateRef<const std::vector<uint8_t>>(std::move(fileData));
+    ImageInfo info;
+    if (!ImageDecoder::Select(*file).readInfo(*file, info))
+        return CreateRef<Image>(path, *file);
+
+    Ref<Image> image(new Image(path, info.width, info.height, info.isHighPrecision()));
+    bool hasThumbnail = image->uploadThumbnail(*file);
+
+    std::weak_ptr<Image> weak = image;
+    Application::Get().getThreadPool().enqueue([weak, path, file, info, hasThumbnail] {
+        if (weak.expired())
+            return;
+
+        VICA_PROFILE_SCOPE("Image::CreateProgressive decode");
+        ImageDecoder& decoder = ImageDecoder::Select(*file);
+
+        // Without a thumbnail, a reduced decode stands in while the full one runs.
+        auto preview = CreateRef<std::vector<uint8_t>>();
+        ImageInfo previewInfo;
+        if (!hasThumbnail && decoder.decodePreview(*file, info, PreviewSize, *preview, previewInfo))
+            Application::Get().submitToMainThread([weak, preview, previewInfo] {
+                if (Ref<Image> image = weak.lock(); image && !image->m_Loaded)
+                    image->uploadPlaceholder(preview->data(), previewInfo.width, previewInfo.height);
+                });
+
+        auto pixels = CreateRef<std::vector<uint8_t>>();
+
+        // High-precision images are converted to half floats here, off the main thread.
+        size_t count = (size_t)info.width * info.height * 4;
+        bool decoded;
+        if (info.isHighPrecision()) {
+            pixels->resize(count * sizeof(uint16_t));
+            decoded = decoder.decodeHalf(*file, info, { (uint16_t*)pixels->data(), count });
+        }
+        else {
+            pixels->resize(count);
+            decoded = decoder.decode(*file, info, *pixels, 4);
+        }
+        if (!decoded) {
+            std::println("Failed to load image {} with {}", path.string(), decoder.getName());
+            return;
+        }
+
+        Application::Get().submitToMainThread([weak, pixels] {
+            if (Ref<Image> image = weak.lock())
+                image->finishProgressive(pixels->data());
+            });
+        });
+
+    return image;
+}
+
+bool vica::Image::uploadThumbnail(std::span<const uint8_t> file) {
+    // The final texture is allocated once, up front; placeholders and the
+    // full image are written into it in place, so the ID never changes.
+    m_ImageID = Application::Get().getTexturePool().acquire(getTextureDesc());
+    trackMemory();
+
+    glTextureParameteri(m_ImageID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(m_ImageID, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(m_ImageID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(m_ImageID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    std::vector<uint8_t> thumbnail = readExifThumbnail(file);
+    int thumbWidth = 0, thumbHeight = 0, channels;
+    stbi_uc* thumbData = thumbnail.empty() ? nullptr : stbi_load_from_memory(thumbnail.data(), (int)thumbnail.size(), &thumbWidth, &thumbHeight, &channels, 4);
+    if (!thumbData) {
+        // Flat grey until decodePreview() or the full decode lands.
+        const uint8_t grey[4] = { 128, 128, 128, 255 };
+        glClearTexImage(m_ImageID, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        return false;
+    }
+
+    uploadPlaceholder(thumbData, (uint32_t)thumbWidth, (uint32_t)thumbHeight);
+    stbi_image_free(thumbData);
+    return true;
+}
+
+void vica::Image::uploadPlaceholder(const uint8_t* pixels, uint32_t width, uint32_t height) {
+    VICA_PROFILE_FUNCTION();
+    // Upload the small RGBA8 image into a scratch texture and let the GPU
+    // scale it onto level 0 of the real one.
+    TextureDesc desc = { width, height, GL_RGBA8, 1 };
+    TexturePool& pool = Application::Get().getTexturePool();
+    uint32_t scratch = pool.acquire(desc);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTextureSubImage2D(scratch, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    GLuint framebuffers[2];
+    glCreateFramebuffers(2, framebuffers);
+    glNamedFramebufferTexture(framebuffers[0], GL_COLOR_ATTACHMENT0, scratch, 0);
+    glNamedFramebufferTexture(framebuffers[1], GL_COLOR_ATTACHMENT0, m_ImageID, 0);
+    glBlitNamedFramebuffer(framebuffers[0], framebuffers[1], 0, 0, width, height, 0, 0, m_Width, m_Height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glDeleteFramebuffers(2, framebuffers);
+
+    pool.release(scratch, desc);
+    Application::Get().invalidateFrame();
+}
+
+void vica::Image::finishProgressive(const void* data) {
+    VICA_PROFILE_FUNCTION();
+    glTextureSubImage2D(m_ImageID, 0, 0, 0, m_Width, m_Height, m_DataFormat, m_DataType, data);
+    m_Loaded = true;
+    Application::Get().invalidateFrame();
+}
+
 vica::Image::~Image() {
-    glDeleteTextures(1, &m_ImageID);
+    s_TextureMemory.fetch_sub(m_MemorySize, std::memory_order_relaxed);
+    Application::Get().getTexturePool().release(m_ImageID, getTextureDesc());
+}
+
+void vica::Image::trackMemory() {
+    size_t size = getTextureDesc().getMemorySize();
+    s_TextureMemory.fetch_add(size - m_MemorySize, std::memory_order_relaxed);
+    m_MemorySize = size;
 }
 
 bool vica::Image::operator==(const Image& other) const {
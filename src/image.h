@@ -1,29 +1,66 @@
+#pragma once
 #include<filesystem>
+#include <atomic>
+#include <span>
+#include <vector>
 #include "uuid.h"
+#include "slotMap.h"
+#include "base.h"
+#include "renderer/texturePool.h"
 
 namespace vica {
     class Image {
     public:
         Image(const std::filesystem::path& path);
+        // Decodes an already-read file (see FileReader::ReadAll).
+        Image(const std::filesystem::path& path, std::span<const uint8_t> file);
         // TODO: Implement this constructor
         // Image(const unsigned char* imageData);
         Image(const char* name, void* data, const uint32_t size, const uint32_t width, const uint32_t height);
         ~Image();
 
+        // Returns immediately with a low-resolution placeholder (the embedded
+        // EXIF thumbnail when present, otherwise a reduced decode such as
+        // JPEG DCT scaling shortly after) and swaps in the full-resolution
+        // pixels once a background decode finishes. The texture ID never
+        // changes.
+        static Ref<Image> CreateProgressive(const std::filesystem::path& path);
+        static Ref<Image> CreateProgressive(const std::filesystem::path& path, std::vector<uint8_t> file);
+        bool isLoaded() const { return m_Loaded; }
+
         uint32_t getWidth() const { return m_Width; }
         uint32_t getHeight() const { return m_Height; }
         const std::string& getName() const { return m_Name; }
         uint32_t getID() const { return m_ImageID; }
+        // GPU memory of this texture, and of all live Images, by internal format (RGBA8, RGBA16F).
+        size_t getMemorySize() const { return m_MemorySize; }
+        static size_t GetTextureMemory() { return s_TextureMemory.load(std::memory_order_relaxed); }
 
         bool operator==(const Image& other) const;
         void bind(uint32_t slot = 0) const;
 
         inline const std::filesystem::path& getPath() const { return m_Path; }
+    private:
+        Image(const std::filesystem::path& path, uint32_t width, uint32_t height, bool highPrecision);
+        // Longer side of the reduced decode used when there is no thumbnail.
+        static constexpr uint32_t PreviewSize = 512;
+
+        bool uploadThumbnail(std::span<const uint8_t> file);
+        void uploadPlaceholder(const uint8_t* pixels, uint32_t width, uint32_t height);
+        void finishProgressive(const void* data);
+        void trackMemory();
+        TextureDesc getTextureDesc() const { return { m_Width, m_Height, m_InternalFormat, 1 }; }
     private:
         std::filesystem::path m_Path;
         std::string m_Name;
         uint32_t m_Width, m_Height;
-        uint32_t m_InternalFormat, m_DataFormat;
+        uint32_t m_InternalFormat, m_DataFormat, m_DataType;
         uint32_t m_ImageID;
+        bool m_Loaded = true;
+        size_t m_MemorySize = 0;
+
+        static std::atomic<size_t> s_TextureMemory;
     };
+
+    using ImageHandle = Handle<Image>;
 } // namespace vica
@@ -0,0 +1,406 @@
+#include "imageDecoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <print>
+#include <string>
+
+#include <stb_image.h>
+#include <imgui.h>
+
+#include "fileReader.h"
+#include "halfFloat.h"
+
+#include <spng.h>
+#include <turbojpeg.h>
+
+namespace vica {
+
+    namespace {
+        bool hasSignature(std::span<const uint8_t> data, std::initializer_list<uint8_t> signature) {
+            return data.size() >= signature.size() && std::equal(signature.begin(), signature.end(), data.begin());
+        }
+
+        // Decodes the whole image on the first read; for backends that cannot stream rows.
+        class WholeImageRowReader : public ImageRowReader {
+        public:
+            WholeImageRowReader(ImageDecoder& decoder, std::span<const uint8_t> data, const ImageInfo& info)
+                : m_Decoder(decoder), m_Data(data), m_Info(info) {
+            }
+
+            bool readRows(uint32_t firstRow, uint32_t rowCount, std::span<uint8_t> dst) override {
+                size_t rowSize = (size_t)m_Info.width * 4;
+                if ((uint64_t)firstRow + rowCount > m_Info.height || dst.size() < rowSize * rowCount)
+                    return false;
+                if (m_Pixels.empty()) {
+                    m_Pixels.resize(rowSize * m_Info.height);
+                    if (!m_Decoder.decode(m_Data, m_Info, m_Pixels, 4)) {
+                        m_Pixels.clear();
+                        return false;
+                    }
+                }
+                std::memcpy(dst.data(), m_Pixels.data() + firstRow * rowSize, rowSize * rowCount);
+                return true;
+            }
+        private:
+            ImageDecoder& m_Decoder;
+            std::span<const uint8_t> m_Data;
+            ImageInfo m_Info;
+            std::vector<uint8_t> m_Pixels;
+        };
+
+        class StbDecoder : public ImageDecoder {
+        public:
+            const char* getName() const override { return "stb_image"; }
+            bool canDecode(std::span<const uint8_t>) const override { return true; }
+
+            bool readInfo(std::span<const uint8_t> data, ImageInfo& info) const override {
+                int width, height, channels;
+                if (!stbi_info_from_memory(data.data(), (int)data.size(), &width, &height, &channels))
+                    return false;
+                info = { (uint32_t)width, (uint32_t)height, (uint32_t)channels };
+                info.isFloat = stbi_is_hdr_from_memory(data.data(), (int)data.size());
+                info.bitDepth = info.isFloat ? 32 : stbi_is_16_bit_from_memory(data.data(), (int)data.size()) ? 16 : 8;
+                return true;
+            }
+        protected:
+            bool decodeImpl(std::span<const uint8_t> data, const ImageInfo& info, std::span<uint8_t> dst, uint32_t channels) override {
+                // stb_image always allocates its own output.
+                int width, height, fileChannels;
+                stbi_uc* pixels = stbi_load_from_memory(data.data(), (int)data.size(), &width, &height, &fileChannels, (int)channels);
+                if (!pixels)
+                    return false;
+                std::memcpy(dst.data(), pixels, (size_t)info.width * info.height * channels);
+                stbi_image_free(pixels);
+                return true;
+            }
+
+            bool decodeHalfImpl(std::span<const uint8_t> data, const ImageInfo& info, std::span<uint16_t> dst) override {
+                int width, height, fileChannels;
+                size_t count = (size_t)info.width * info.height * 4;
+                if (info.isFloat) {
+                    float* pixels = stbi_loadf_from_memory(data.data(), (int)data.size(), &width, &height, &fileChannels, 4);
+                    if (!pixels)
+                        return false;
+                    convertFloatToHalf(pixels, dst.data(), count);
+                    stbi_image_free(pixels);
+                }
+                else {
+                    stbi_us* pixels = stbi_load_16_from_memory(data.data(), (int)data.size(), &width, &height, &fileChannels, 4);
+                    if (!pixels)
+                        return false;
+                    convertUnorm16ToHalf(pixels, dst.data(), count);
+                    stbi_image_free(pixels);
+                }
+                return true;
+            }
+        };
+
+        class SpngDecoder : public ImageDecoder {
+        public:
+            const char* getName() const override { return "libspng"; }
+            bool canDecode(std::span<const uint8_t> data) const override { return hasSignature(data, { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' }); }
+
+            bool readInfo(std::span<const uint8_t> data, ImageInfo& info) const override {
+                Context ctx(data);
+                spng_ihdr ihdr;
+                if (!ctx || spng_get_ihdr(ctx, &ihdr))
+                    return false;
+
+                spng_trns trns;
+                bool alpha = ihdr.color_type == SPNG_COLOR_TYPE_TRUECOLOR_ALPHA || ihdr.color_type == SPNG_COLOR_TYPE_GRAYSCALE_ALPHA || !spng_get_trns(ctx, &trns);
+                info = { ihdr.width, ihdr.height, alpha ? 4u : 3u, ihdr.bit_depth };
+                return true;
+            }
+        protected:
+            bool decodeImpl(std::span<const uint8_t> data, const ImageInfo&, std::span<uint8_t> dst, uint32_t channels) override {
+                Context ctx(data);
+                int format = channels == 4 ? SPNG_FMT_RGBA8 : SPNG_FMT_RGB8;
+                size_t size;
+                if (!ctx || spng_decoded_image_size(ctx, format, &size) || size > dst.size())
+                    return false;
+                return !spng_decode_image(ctx, dst.data(), size, format, SPNG_DECODE_TRNS);
+            }
+
+            bool decodeHalfImpl(std::span<const uint8_t> data, const ImageInfo&, std::span<uint16_t> dst) override {
+                // RGBA16 has the same footprint as RGBA16F: decode in place, then convert.
+                Context ctx(data);
+                size_t size;
+                if (!ctx || spng_decoded_image_size(ctx, SPNG_FMT_RGBA16, &size) || size > dst.size_bytes())
+                    return false;
+                if (spng_decode_image(ctx, dst.data(), size, SPNG_FMT_RGBA16, SPNG_DECODE_TRNS))
+                    return false;
+                convertUnorm16ToHalf(dst.data(), dst.data(), size / 2);
+                return true;
+            }
+
+            Scope<ImageRowReader> openRows(std::span<const uint8_t> data, const ImageInfo& info) override {
+                // Interlaced (Adam7) rows arrive pass by pass, not top to bottom.
+                Context ctx(data);
+                spng_ihdr ihdr;
+                if (!ctx || spng_get_ihdr(ctx, &ihdr) || ihdr.interlace_method != SPNG_INTERLACE_NONE)
+                    return ImageDecoder::openRows(data, info);
+                return CreateScope<RowReader>(data, info.width);
+            }
+        private:
+            struct Context {
+                spng_ctx* ctx = spng_ctx_new(0);
+
+                Context(std::span<const uint8_t> data) {
+                    if (ctx && spng_set_png_buffer(ctx, data.data(), data.size())) {
+                        spng_ctx_free(ctx);
+                        ctx = nullptr;
+                    }
+                }
+                ~Context() { spng_ctx_free(ctx); }
+                operator spng_ctx*() const { return ctx; }
+            };
+
+            // Progressive decode: one inflate stream, so rows are only cheap going down.
+            class RowReader : public ImageRowReader {
+            public:
+                RowReader(std::span<const uint8_t> data, uint32_t width)
+                    : m_Data(data), m_RowSize((size_t)width * 4), m_Scratch(m_RowSize) {
+                }
+
+                bool readRows(uint32_t firstRow, uint32_t rowCount, std::span<uint8_t> dst) override {
+                    if (dst.size() < m_RowSize * rowCount)
+                        return false;
+                    if ((!m_Context || firstRow < m_NextRow) && !restart())
+                        return false;
+                    while (m_NextRow < firstRow)
+                        if (!decodeRow(m_Scratch.data()))
+                            return false;
+                    for (uint32_t i = 0; i < rowCount; i++)
+                        if (!decodeRow(dst.data() + i * m_RowSize))
+                            return false;
+                    return true;
+                }
+            private:
+                bool restart() {
+                    m_Context = CreateScope<Context>(m_Data);
+                    m_NextRow = 0;
+                    if (*m_Context && !spng_decode_image(*m_Context, nullptr, 0, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS | SPNG_DECODE_PROGRESSIVE))
+                        return true;
+                    m_Context.reset();
+                    return false;
+                }
+
+                bool decodeRow(uint8_t* row) {
+                    // SPNG_EOI comes with the last row.
+                    int result = spng_decode_row(*m_Context, row, m_RowSize);
+                    if (result && result != SPNG_EOI) {
+                        m_Context.reset();
+                        return false;
+                    }
+                    m_NextRow++;
+                    return true;
+                }
+            private:
+                std::span<const uint8_t> m_Data;
+                size_t m_RowSize;
+                std::vector<uint8_t> m_Scratch;
+                Scope<Context> m_Context;
+                uint32_t m_NextRow = 0;
+            };
+        };
+
+        class TurboJpegDecoder : public ImageDecoder {
+        public:
+            const char* getName() const override { return "libjpeg-turbo"; }
+            bool canDecode(std::span<const uint8_t> data) const override { return hasSignature(data, { 0xFF, 0xD8, 0xFF }); }
+
+            bool readInfo(std::span<const uint8_t> data, ImageInfo& info) const override {
+                int width, height, subsampling, colorspace;
+                if (tjDecompressHeader3(getHandle(), data.data(), (unsigned long)data.size(), &width, &height, &subsampling, &colorspace))
+                    return false;
+                info = { (uint32_t)width, (uint32_t)height, 3 };
+                return true;
+            }
+
+            bool decodePreview(std::span<const uint8_t> data, const ImageInfo& info, uint32_t maxSize, std::vector<uint8_t>& dst, ImageInfo& preview) override {
+                // The IDCT skips the coefficients it does not need, so a 1/8
+                // decode costs a fraction of the full one. Factors are sorted
+                // largest first; take the first that fits.
+                int count;
+                tjscalingfactor* factors = tjGetScalingFactors(&count);
+                if (!factors || !count)
+                    return false;
+
+                tjscalingfactor factor = factors[count - 1];
+                for (int i = 0; i < count; i++)
+                    if ((uint32_t)TJSCALED((int)std::max(info.width, info.height), factors[i]) <= maxSize) {
+                        factor = factors[i];
+                        break;
+                    }
+
+                preview = { (uint32_t)TJSCALED((int)info.width, factor), (uint32_t)TJSCALED((int)info.height, factor), 4 };
+                dst.resize((size_t)preview.width * preview.height * 4);
+                return !tjDecompress2(getHandle(), data.data(), (unsigned long)data.size(), dst.data(),
+                    (int)preview.width, 0, (int)preview.height, TJPF_RGBA, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE);
+            }
+        protected:
+            bool decodeImpl(std::span<const uint8_t> data, const ImageInfo& info, std::span<uint8_t> dst, uint32_t channels) override {
+                return !tjDecompress2(getHandle(), data.data(), (unsigned long)data.size(), dst.data(),
+                    (int)info.width, 0, (int)info.height, channels == 4 ? TJPF_RGBA : TJPF_RGB, TJFLAG_FASTDCT);
+            }
+
+            Scope<ImageRowReader> openRows(std::span<const uint8_t> data, const ImageInfo&) override {
+                return CreateScope<RowReader>(data);
+            }
+        private:
+            // Decodes just the requested rows: the cropping region skips the
+            // IDCT and color conversion of everything above and below.
+            class RowReader : public ImageRowReader {
+            public:
+                RowReader(std::span<const uint8_t> data) : m_Data(data), m_Handle(tj3Init(TJINIT_DECOMPRESS)) {}
+                ~RowReader() { tj3Destroy(m_Handle); }
+
+                bool readRows(uint32_t firstRow, uint32_t rowCount, std::span<uint8_t> dst) override {
+                    if (!m_Handle || tj3DecompressHeader(m_Handle, m_Data.data(), m_Data.size()))
+                        return false;
+                    if ((size_t)tj3Get(m_Handle, TJPARAM_JPEGWIDTH) * 4 * rowCount > dst.size())
+                        return false;
+                    tj3Set(m_Handle, TJPARAM_FASTDCT, 1);
+                    if (tj3SetCroppingRegion(m_Handle, { 0, (int)firstRow, 0, (int)rowCount }))
+                        return false;
+                    return !tj3Decompress8(m_Handle, m_Data.data(), m_Data.size(), dst.data(), 0, TJPF_RGBA);
+                }
+            private:
+                std::span<const uint8_t> m_Data;
+                tjhandle m_Handle;
+            };
+
+            // tjhandles are not thread-safe; decodes run on the thread pool.
+            static tjhandle getHandle() {
+                struct Handle {
+                    tjhandle handle = tjInitDecompress();
+                    ~Handle() { tjDestroy(handle); }
+                };
+                thread_local Handle t_Handle;
+                return t_Handle.handle;
+            }
+        };
+    }
+
+    bool ImageDecoder::decode(std::span<const uint8_t> data, const ImageInfo& info, std::span<uint8_t> dst, uint32_t channels) {
+        size_t size = (size_t)info.width * info.height * channels;
+        if ((channels != 3 && channels != 4) || dst.size() < size)
+            return false;
+
+        auto start = std::chrono::steady_clock::now();
+        if (!decodeImpl(data, info, dst, channels))
+            return canFallBack(data, info) && GetDecoders().back()->decode(data, info, dst, channels);
+        addStats(size, start);
+        return true;
+    }
+
+    Scope<ImageRowReader> ImageDecoder::openRows(std::span<const uint8_t> data, const ImageInfo& info) {
+        return CreateScope<WholeImageRowReader>(*this, data, info);
+    }
+
+    bool ImageDecoder::decodeHalf(std::span<const uint8_t> data, const ImageInfo& info, std::span<uint16_t> dst) {
+        size_t count = (size_t)info.width * info.height * 4;
+        if (dst.size() < count)
+            return false;
+
+        auto start = std::chrono::steady_clock::now();
+        if (!decodeHalfImpl(data, info, dst))
+            return canFallBack(data, info) && GetDecoders().back()->decodeHalf(data, info, dst);
+        addStats(count * sizeof(uint16_t), start);
+        return true;
+    }
+
+    bool ImageDecoder::canFallBack(std::span<const uint8_t> data, const ImageInfo& info) const {
+        // The fast backends reject some files stb_image reads fine (progressive
+        // or CMYK JPEGs, unusual PNG chunks); hand those to it, provided it
+        // sees the same image the caller sized its buffer for.
+        const ImageDecoder& fallback = *GetDecoders().back();
+        ImageInfo fallbackInfo;
+        return &fallback != this && fallback.readInfo(data, fallbackInfo)
+            && fallbackInfo.width == info.width && fallbackInfo.height == info.height && fallbackInfo.isHighPrecision() == info.isHighPrecision();
+    }
+
+    void ImageDecoder::addStats(size_t bytes, std::chrono::steady_clock::time_point start) {
+        m_Stats.images.fetch_add(1, std::memory_order_relaxed);
+        m_Stats.outputBytes.fetch_add(bytes, std::memory_order_relaxed);
+        m_Stats.nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+    }
+
+    std::span<const Scope<ImageDecoder>> ImageDecoder::GetDecoders() {
+        static const std::vector<Scope<ImageDecoder>> decoders = [] {
+            std::vector<Scope<ImageDecoder>> decoders;
+            decoders.push_back(CreateScope<SpngDecoder>());
+            decoders.push_back(CreateScope<TurboJpegDecoder>());
+            decoders.push_back(CreateScope<StbDecoder>());
+            return decoders;
+        }();
+        return decoders;
+    }
+
+    ImageDecoder& ImageDecoder::Select(std::span<const uint8_t> data) {
+        // A backend that cannot parse the header is skipped, not chosen.
+        ImageInfo info;
+        for (const auto& decoder : GetDecoders())
+            if (decoder->canDecode(data) && decoder->readInfo(data, info))
+                return *decoder;
+        return *GetDecoders().back();
+    }
+
+    void ImageDecoder::Benchmark(const std::filesystem::path& directory, uint32_t iterations) {
+        struct Result {
+            uint32_t files = 0;
+            uint64_t bytes = 0;
+            double seconds = 0.0;
+        };
+        std::map<std::pair<std::string, std::string>, Result> results;
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+            if (!entry.is_regular_file())
+                continue;
+
+            std::vector<uint8_t> file = readFileBytes(entry.path());
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+            for (const auto& decoder : GetDecoders()) {
+                ImageInfo info;
+                if (!decoder->canDecode(file) || !decoder->readInfo(file, info))
+                    continue;
+
+                uint32_t channels = info.channels == 4 || info.channels == 2 ? 4 : 3;
+                std::vector<uint8_t> pixels((size_t)info.width * info.height * channels);
+
+                auto start = std::chrono::steady_clock::now();
+                uint32_t decoded = 0;
+                // decodeImpl, so a file a backend rejects is not timed as stb's fallback.
+                for (uint32_t i = 0; i < iterations; i++)
+                    decoded += decoder->decodeImpl(file, info, pixels, channels);
+                if (!decoded)
+                    continue;
+
+                Result& result = results[{ ext, decoder->getName() }];
+                result.files++;
+                result.bytes += (uint64_t)decoded * pixels.size();
+                result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+        }
+
+        std::println("{:<8} {:<14} {:>6} {:>12}", "format", "decoder", "files", "MB/s");
+        for (const auto& [key, result] : results)
+            std::println("{:<8} {:<14} {:>6} {:>12.1f}", key.first, key.second, result.files, result.bytes / result.seconds / 1e6);
+    }
+
+    void ImageDecoder::OnImGuiRender() {
+        for (const auto& decoder : GetDecoders()) {
+            const Stats& stats = decoder->getStats();
+            double seconds = stats.nanoseconds.load(std::memory_order_relaxed) / 1e9;
+            uint64_t bytes = stats.outputBytes.load(std::memory_order_relaxed);
+            ImGui::Text("%-14s %6llu images  %8.1f MB/s", decoder->getName(),
+                (unsigned long long)stats.images.load(std::memory_order_relaxed), seconds > 0.0 ? bytes / seconds / 1e6 : 0.0);
+        }
+    }
+
+} // namespace vica
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "base.h"
+
+namespace vica {
+    struct ImageInfo {
+        uint32_t width = 0, height = 0;
+        uint32_t channels = 0; // channels stored in the file
+        uint32_t bitDepth = 8; // per channel
+        bool isFloat = false;  // Radiance .hdr
+
+        bool isHighPrecision() const { return isFloat || bitDepth > 8; }
+    };
+
+    // Top-to-bottom RGBA8 row access for images too large to decode at once.
+    // The file must outlive the reader.
+    class ImageRowReader {
+    public:
+        virtual ~ImageRowReader() = default;
+        // Rows [firstRow, firstRow + rowCount) into dst, width * 4 bytes each.
+        // Reading downwards is cheapest; going back up may restart the decode.
+        virtual bool readRows(uint32_t firstRow, uint32_t rowCount, std::span<uint8_t> dst) = 0;
+    };
+
+    // Decodes an in-memory image file into a caller-provided buffer (heap,
+    // mapped staging buffer, ...) of width * height * channels bytes, rows
+    // tightly packed. Backends are picked by file signature; the stb_image
+    // decoder accepts everything and is registered last as the fallback,
+    // also for files a faster backend fails to decode.
+    class ImageDecoder {
+    public:
+        struct Stats {
+            std::atomic<uint64_t> images{ 0 };
+            std::atomic<uint64_t> outputBytes{ 0 };
+            std::atomic<uint64_t> nanoseconds{ 0 };
+        };
+
+        virtual ~ImageDecoder() = default;
+
+        virtual const char* getName() const = 0;
+        virtual bool canDecode(std::span<const uint8_t> data) const = 0;
+        virtual bool readInfo(std::span<const uint8_t> data, ImageInfo& info) const = 0;
+        // channels is 3 (RGB8) or 4 (RGBA8).
+        bool decode(std::span<const uint8_t> data, const ImageInfo& info, std::span<uint8_t> dst, uint32_t channels);
+        // RGBA16F for high-precision sources (float or 16-bit); dst holds width * height * 4 halves.
+        bool decodeHalf(std::span<const uint8_t> data, const ImageInfo& info, std::span<uint16_t> dst);
+        // Cheap reduced-size RGBA8 decode for placeholders (JPEG DCT scaling),
+        // no larger than maxSize on the longer side unless the backend cannot
+        // scale that far. preview receives its size. False when the backend
+        // has no path cheaper than a full decode.
+        virtual bool decodePreview(std::span<const uint8_t>, const ImageInfo&, uint32_t /*maxSize*/, std::vector<uint8_t>& /*dst*/, ImageInfo& /*preview*/) { return false; }
+        // Backends without incremental decoding decode the whole image on the
+        // first read and serve rows from that.
+        virtual Scope<ImageRowReader> openRows(std::span<const uint8_t> data, const ImageInfo& info);
+
+        const Stats& getStats() const { return m_Stats; }
+
+        static ImageDecoder& Select(std::span<const uint8_t> data);
+        static std::span<const Scope<ImageDecoder>> GetDecoders();
+
+        // Decodes every image under directory with each decoder that accepts
+        // it and prints throughput per file format and decoder.
+        static void Benchmark(const std::filesystem::path& directory, uint32_t iterations = 5);
+        static void OnImGuiRender();
+    protected:
+        virtual bool decodeImpl(std::span<const uint8_t> data, const ImageInfo& info, std::span<uint8_t> dst, uint32_t channels) = 0;
+        virtual bool decodeHalfImpl(std::span<const uint8_t>, const ImageInfo&, std::span<uint16_t>) { return false; }
+    private:
+        void addStats(size_t bytes, std::chrono::steady_clock::time_point start);
+        bool canFallBack(std::span<const uint8_t> data, const ImageInfo& info) const;
+    private:
+        Stats m_Stats;
+    };
+
+} // namespace vica
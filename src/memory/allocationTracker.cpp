@@ -0,0 +1,261 @@
+#include "allocationTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <print>
+#include <sstream>
+
+#include <imgui.h>
+
+namespace vica {
+
+    namespace {
+        constexpr size_t TagCount = (size_t)AllocationTag::Count;
+        constexpr size_t MaxTagDepth = 32;
+        constexpr size_t HistorySize = 120;
+
+        struct AtomicCounters {
+            std::atomic<uint64_t> count{ 0 };
+            std::atomic<uint64_t> bytes{ 0 };
+        };
+
+        // Everything touched from operator new must be constant-initialized:
+        // the hooks run before (and after) dynamic initialization.
+        AtomicCounters s_Frame[TagCount];
+        AtomicCounters s_Total[TagCount];
+        std::atomic<int64_t> s_Live[TagCount];
+        std::atomic<int64_t> s_LiveTotal{ 0 };
+        std::atomic<int64_t> s_PeakTotal{ 0 };
+
+        thread_local AllocationTag t_TagStack[MaxTagDepth];
+        thread_local uint32_t t_TagDepth = 0;
+        thread_local uint64_t t_AllocationCount = 0;
+
+        AllocationTracker::TagStats s_Snapshot[TagCount];
+        float s_FrameHistory[HistorySize];
+        uint32_t s_FrameHistoryOffset = 0;
+    }
+
+    const char* getAllocationTagName(AllocationTag tag) {
+        switch (tag) {
+        case AllocationTag::Untagged: return "Untagged";
+        case AllocationTag::Events:   return "Events";
+        case AllocationTag::Images:   return "Images";
+        case AllocationTag::Scenes:   return "Scenes";
+        case AllocationTag::ImGui:    return "ImGui";
+        case AllocationTag::User:     return "User";
+        default:                      return "Unknown";
+        }
+    }
+
+    void AllocationTracker::pushTag(AllocationTag tag) {
+        if (t_TagDepth < MaxTagDepth)
+            t_TagStack[t_TagDepth] = tag;
+        t_TagDepth++;
+    }
+
+    void AllocationTracker::popTag() {
+        if (t_TagDepth)
+            t_TagDepth--;
+    }
+
+    AllocationTag AllocationTracker::getCurrentTag() {
+        if (!t_TagDepth)
+            return AllocationTag::Untagged;
+        return t_TagStack[std::min<size_t>(t_TagDepth, MaxTagDepth) - 1];
+    }
+
+    uint64_t AllocationTracker::getThreadAllocationCount() {
+        return t_AllocationCount;
+    }
+
+    void AllocationTracker::endFrame() {
+        uint64_t frameCount = 0;
+        for (size_t i = 0; i < TagCount; i++) {
+            TagStats& stats = s_Snapshot[i];
+            stats.frame.count = s_Frame[i].count.exchange(0, std::memory_order_relaxed);
+            stats.frame.bytes = s_Frame[i].bytes.exchange(0, std::memory_order_relaxed);
+            stats.total.count = s_Total[i].count.load(std::memory_order_relaxed);
+            stats.total.bytes = s_Total[i].bytes.load(std::memory_order_relaxed);
+            stats.liveBytes = s_Live[i].load(std::memory_order_relaxed);
+            frameCount += stats.frame.count;
+        }
+
+        s_FrameHistory[s_FrameHistoryOffset] = (float)frameCount;
+        s_FrameHistoryOffset = (s_FrameHistoryOffset + 1) % HistorySize;
+    }
+
+    const AllocationTracker::TagStats& AllocationTracker::getStats(AllocationTag tag) {
+        return s_Snapshot[(size_t)tag];
+    }
+
+    AllocationTracker::Counters AllocationTracker::getFrameTotal() {
+        Counters total;
+        for (const TagStats& stats : s_Snapshot) {
+            total.count += stats.frame.count;
+            total.bytes += stats.frame.bytes;
+        }
+        return total;
+    }
+
+    int64_t AllocationTracker::getLiveBytes() {
+        return s_LiveTotal.load(std::memory_order_relaxed);
+    }
+
+    int64_t AllocationTracker::getPeakBytes() {
+        return s_PeakTotal.load(std::memory_order_relaxed);
+    }
+
+    std::string AllocationTracker::toJson() {
+        std::ostringstream json;
+        Counters frame = getFrameTotal();
+
+        json << "{\n";
+        json << "  \"enabled\": " << (isEnabled() ? "true" : "false") << ",\n";
+        json << "  \"frame\": { \"count\": " << frame.count << ", \"bytes\": " << frame.bytes << " },\n";
+        json << "  \"liveBytes\": " << getLiveBytes() << ",\n";
+        json << "  \"peakBytes\": " << getPeakBytes() << ",\n";
+        json << "  \"tags\": {\n";
+        for (size_t i = 0; i < TagCount; i++) {
+            const TagStats& stats = s_Snapshot[i];
+            json << "    \"" << getAllocationTagName((AllocationTag)i) << "\": { "
+                << "\"frameCount\": " << stats.frame.count << ", "
+                << "\"frameBytes\": " << stats.frame.bytes << ", "
+                << "\"totalCount\": " << stats.total.count << ", "
+                << "\"totalBytes\": " << stats.total.bytes << ", "
+                << "\"liveBytes\": " << stats.liveBytes << " }"
+                << (i + 1 < TagCount ? ",\n" : "\n");
+        }
+        json << "  }\n}\n";
+        return json.str();
+    }
+
+    void AllocationTracker::onImGuiRender() {
+        if (!isEnabled()) {
+            ImGui::TextDisabled("Build with VICA_TRACK_ALLOCATIONS to enable.");
+            return;
+        }
+
+        Counters frame = getFrameTotal();
+        ImGui::Text("Frame: %llu allocations, %llu bytes", (unsigned long long)frame.count, (unsigned long long)frame.bytes);
+        ImGui::Text("Live: %lld bytes  Peak: %lld bytes", (long long)getLiveBytes(), (long long)getPeakBytes());
+        ImGui::PlotLines("##allocations", s_FrameHistory, (int)HistorySize, (int)s_FrameHistoryOffset, "allocations/frame", 0.0f, FLT_MAX, { 0, 40 });
+
+        if (ImGui::BeginTable("##allocationTags", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Tag");
+            ImGui::TableSetupColumn("Frame count");
+            ImGui::TableSetupColumn("Frame bytes");
+            ImGui::TableSetupColumn("Live bytes");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < TagCount; i++) {
+                const TagStats& stats = s_Snapshot[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(getAllocationTagName((AllocationTag)i));
+                ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)stats.frame.count);
+                ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)stats.frame.bytes);
+                ImGui::TableNextColumn(); ImGui::Text("%lld", (long long)stats.liveBytes);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    NoAllocationScope::NoAllocationScope(const char* name)
+        : m_Name(name), m_Start(AllocationTracker::getThreadAllocationCount()) {
+    }
+
+    NoAllocationScope::~NoAllocationScope() {
+        uint64_t count = getAllocationCount();
+        if (count) {
+            std::println("{} performed {} heap allocations in a no-allocation scope", m_Name, count);
+            assert(!"heap allocation in no-allocation scope");
+        }
+    }
+
+} // namespace vica
+
+#ifdef VICA_TRACK_ALLOCATIONS
+
+namespace {
+    using namespace vica;
+
+    // Sits directly in front of every tracked block.
+    struct alignas(16) AllocationHeader {
+        uint64_t size;
+        uint32_t offset; // from the malloc'd base to the user pointer
+        AllocationTag tag;
+    };
+    static_assert(sizeof(AllocationHeader) == 16);
+
+    void* trackedAllocate(size_t size, size_t alignment) {
+        alignment = std::max(alignment, alignof(AllocationHeader));
+        size_t padding = sizeof(AllocationHeader) + alignment - alignof(AllocationHeader);
+
+        auto* base = static_cast<std::byte*>(std::malloc(size + padding));
+        if (!base)
+            return nullptr;
+
+        uintptr_t user = ((uintptr_t)base + sizeof(AllocationHeader) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        auto* header = reinterpret_cast<AllocationHeader*>(user) - 1;
+        header->size = size;
+        header->offset = (uint32_t)(user - (uintptr_t)base);
+        header->tag = AllocationTracker::getCurrentTag();
+
+        size_t tag = (size_t)header->tag;
+        s_Frame[tag].count.fetch_add(1, std::memory_order_relaxed);
+        s_Frame[tag].bytes.fetch_add(size, std::memory_order_relaxed);
+        s_Total[tag].count.fetch_add(1, std::memory_order_relaxed);
+        s_Total[tag].bytes.fetch_add(size, std::memory_order_relaxed);
+        s_Live[tag].fetch_add((int64_t)size, std::memory_order_relaxed);
+
+        int64_t live = s_LiveTotal.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+        int64_t peak = s_PeakTotal.load(std::memory_order_relaxed);
+        while (live > peak && !s_PeakTotal.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+
+        t_AllocationCount++;
+        return reinterpret_cast<void*>(user);
+    }
+
+    void trackedFree(void* ptr) {
+        if (!ptr)
+            return;
+
+        auto* header = static_cast<AllocationHeader*>(ptr) - 1;
+        s_Live[(size_t)header->tag].fetch_sub((int64_t)header->size, std::memory_order_relaxed);
+        s_LiveTotal.fetch_sub((int64_t)header->size, std::memory_order_relaxed);
+        std::free(static_cast<std::byte*>(ptr) - header->offset);
+    }
+
+    void* trackedAllocateOrThrow(size_t size, size_t alignment) {
+        if (void* ptr = trackedAllocate(size, alignment))
+            return ptr;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(size_t size) { return trackedAllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size) { return trackedAllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t alignment) { return trackedAllocateOrThrow(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return trackedAllocateOrThrow(size, (size_t)alignment); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return trackedAllocate(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return trackedAllocate(size, (size_t)alignment); }
+
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+
+#endif // VICA_TRACK_ALLOCATIONS
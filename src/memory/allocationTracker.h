@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Heap allocation tracking. Compiled in only with VICA_TRACK_ALLOCATIONS
+// (cmake -DVICA_TRACK_ALLOCATIONS=ON), which replaces global operator
+// new/delete. Without it the tracker reports nothing and the scope macros
+// expand to nothing.
+
+namespace vica {
+    enum class AllocationTag : uint8_t {
+        Untagged = 0,
+        Events,
+        Images,
+        Scenes,
+        ImGui,
+        User,
+        Count
+    };
+
+    const char* getAllocationTagName(AllocationTag tag);
+
+    class AllocationTracker {
+    public:
+        struct Counters {
+            uint64_t count = 0;
+            uint64_t bytes = 0;
+        };
+
+        struct TagStats {
+            Counters frame;
+            Counters total;
+            int64_t liveBytes = 0;
+        };
+
+        static constexpr bool isEnabled() {
+#ifdef VICA_TRACK_ALLOCATIONS
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        static void pushTag(AllocationTag tag);
+        static void popTag();
+        static AllocationTag getCurrentTag();
+
+        // Allocations made by the calling thread since it started.
+        static uint64_t getThreadAllocationCount();
+
+        static void endFrame();
+        static const TagStats& getStats(AllocationTag tag);
+        static Counters getFrameTotal();
+        static int64_t getLiveBytes();
+        static int64_t getPeakBytes();
+
+        static std::string toJson();
+        static void onImGuiRender();
+    };
+
+    class AllocationScope {
+    public:
+        AllocationScope(AllocationTag tag) { AllocationTracker::pushTag(tag); }
+        ~AllocationScope() { AllocationTracker::popTag(); }
+    };
+
+    // Asserts that the enclosing scope performs no heap allocation on this thread.
+    class NoAllocationScope {
+    public:
+        NoAllocationScope(const char* name);
+        ~NoAllocationScope();
+
+        uint64_t getAllocationCount() const { return AllocationTracker::getThreadAllocationCount() - m_Start; }
+    private:
+        const char* m_Name;
+        uint64_t m_Start;
+    };
+
+} // namespace vica
+
+#define VICA_ALLOC_CONCAT_IMPL(a, b) a##b
+#define VICA_ALLOC_CONCAT(a, b) VICA_ALLOC_CONCAT_IMPL(a, b)
+
+#ifdef VICA_TRACK_ALLOCATIONS
+#define VICA_ALLOC_SCOPE(tag) ::vica::AllocationScope VICA_ALLOC_CONCAT(allocScope, __LINE__)(tag)
+#define VICA_ASSERT_NO_ALLOC_SCOPE(name) ::vica::NoAllocationScope VICA_ALLOC_CONCAT(noAllocScope, __LINE__)(name)
+#else
+#define VICA_ALLOC_SCOPE(tag)
+#define VICA_ASSERT_NO_ALLOC_SCOPE(name)
+#endif
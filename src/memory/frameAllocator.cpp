@@ -0,0 +1,69 @@
+#include "frameAllocator.h"
+
+#include <new>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace vica {
+
+    LinearArena::LinearArena(size_t capacity)
+        : m_Capacity(capacity) {
+        m_Buffer = static_cast<std::byte*>(::operator new(m_Capacity, std::align_val_t{ alignof(std::max_align_t) }));
+    }
+
+    LinearArena::~LinearArena() {
+        for (const Overflow& block : m_Overflow)
+            ::operator delete(block.memory, std::align_val_t{ block.alignment });
+        ::operator delete(m_Buffer, std::align_val_t{ alignof(std::max_align_t) });
+    }
+
+    void* LinearArena::allocate(size_t size, size_t alignment) {
+        // Align the address, not the offset: the buffer itself is only
+        // max_align_t-aligned.
+        uintptr_t base = reinterpret_cast<uintptr_t>(m_Buffer);
+        size_t aligned = ((base + m_Offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+        if (aligned + size <= m_Capacity) {
+            m_Offset = aligned + size;
+            m_HighWater = std::max(m_HighWater, getUsed());
+            return m_Buffer + aligned;
+        }
+
+        alignment = std::max(alignment, alignof(std::max_align_t));
+        void* memory = ::operator new(size, std::align_val_t{ alignment });
+        m_Overflow.push_back({ memory, size, alignment });
+        m_OverflowBytes += size;
+        m_HighWater = std::max(m_HighWater, getUsed());
+        return memory;
+    }
+
+    void LinearArena::reset() {
+        for (const Overflow& block : m_Overflow)
+            ::operator delete(block.memory, std::align_val_t{ block.alignment });
+        m_Overflow.clear();
+
+        if (m_HighWater > m_Capacity) {
+            ::operator delete(m_Buffer, std::align_val_t{ alignof(std::max_align_t) });
+            m_Capacity = std::bit_ceil(m_HighWater);
+            m_Buffer = static_cast<std::byte*>(::operator new(m_Capacity, std::align_val_t{ alignof(std::max_align_t) }));
+        }
+
+        m_Offset = 0;
+        m_OverflowBytes = 0;
+    }
+
+    FrameAllocator::FrameAllocator(size_t capacity)
+        : m_Arenas{ LinearArena(capacity), LinearArena(capacity) },
+        m_Resources{ ArenaResource(m_Arenas[0]), ArenaResource(m_Arenas[1]) } {
+    }
+
+    void FrameAllocator::endFrame() {
+        m_Stats.lastFrameBytes = m_Arenas[m_Current].getUsed();
+        m_Stats.highWater = std::max(m_Arenas[0].getHighWater(), m_Arenas[1].getHighWater());
+
+        m_Current ^= 1;
+        m_Arenas[m_Current].reset();
+        m_Stats.capacity = m_Arenas[m_Current].getCapacity();
+    }
+
+} // namespace vica
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <memory_resource>
+
+#include "base.h"
+
+namespace vica {
+    // Bump allocator. Individual frees are no-ops; everything is released by
+    // reset(). Requests that do not fit spill into upstream blocks, and the
+    // next reset() grows the main block so steady state never spills.
+    class LinearArena {
+    public:
+        explicit LinearArena(size_t capacity);
+        ~LinearArena();
+
+        LinearArena(const LinearArena&) = delete;
+        LinearArena& operator=(const LinearArena&) = delete;
+
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+        void reset();
+
+        size_t getUsed() const { return m_Offset + m_OverflowBytes; }
+        size_t getCapacity() const { return m_Capacity; }
+        size_t getHighWater() const { return m_HighWater; }
+    private:
+        struct Overflow {
+            void* memory;
+            size_t size;
+            size_t alignment;
+        };
+
+        std::byte* m_Buffer = nullptr;
+        size_t m_Capacity = 0;
+        size_t m_Offset = 0;
+        size_t m_HighWater = 0;
+
+        std::vector<Overflow> m_Overflow;
+        size_t m_OverflowBytes = 0;
+    };
+
+    class ArenaResource : public std::pmr::memory_resource {
+    public:
+        explicit ArenaResource(LinearArena& arena) : m_Arena(arena) {}
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override { return m_Arena.allocate(bytes, alignment); }
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        LinearArena& m_Arena;
+    };
+
+    // Double-buffered per-frame arena. Memory handed out during frame N stays
+    // valid until the end of frame N + 1, so data may cross one frame
+    // boundary (e.g. events queued after the event loop drained).
+    // Main thread only.
+    class FrameAllocator {
+    public:
+        struct Stats {
+            size_t lastFrameBytes = 0;
+            size_t highWater = 0;
+            size_t capacity = 0;
+        };
+
+        explicit FrameAllocator(size_t capacity = 64 * 1024);
+
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) { return m_Arenas[m_Current].allocate(size, alignment); }
+        std::pmr::memory_resource* getResource() { return &m_Resources[m_Current]; }
+
+        template<typename T>
+        std::pmr::polymorphic_allocator<T> getAllocator() { return std::pmr::polymorphic_allocator<T>(getResource()); }
+
+        void endFrame();
+        const Stats& getStats() const { return m_Stats; }
+    private:
+        LinearArena m_Arenas[2];
+        ArenaResource m_Resources[2];
+        uint32_t m_Current = 0;
+        Stats m_Stats;
+    };
+
+    // Ref whose storage (object and control block) lives in the frame arena.
+    template<typename T, typename ... Args>
+    Ref<T> CreateFrameRef(FrameAllocator& allocator, Args&& ... args) {
+        return std::allocate_shared<T>(allocator.getAllocator<T>(), std::forward<Args>(args)...);
+    }
+
+} // namespace vica
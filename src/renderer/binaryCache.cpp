@@ -0,0 +1,345 @@
+#include "binaryCache.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <print>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <glad/glad.h>
+#include <imgui.h>
+
+namespace vica {
+
+    namespace {
+        constexpr uint32_t CacheMagic = 0x48434356; // "VCCH"
+        constexpr uint32_t CacheFormatVersion = 1;
+        const std::filesystem::path s_CacheDirectory = "cache";
+
+        struct CacheHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t key;
+            uint64_t payloadSize;
+        };
+
+        // FNV-1a; the key only has to change when its inputs do.
+        struct Hasher {
+            uint64_t value = 0xCBF29CE484222325ull;
+
+            void add(const void* data, size_t size) {
+                for (size_t i = 0; i < size; i++)
+                    value = (value ^ ((const uint8_t*)data)[i]) * 0x100000001B3ull;
+            }
+
+            void add(std::string_view text) {
+                add(text.data(), text.size());
+                add('\0');
+            }
+
+            template<typename T>
+            void add(const T& data) {
+                static_assert(std::is_trivially_copyable_v<T>);
+                add(&data, sizeof(T));
+            }
+        };
+
+        std::optional<std::vector<uint8_t>> readCacheFile(const std::filesystem::path& path, uint64_t key) {
+            std::ifstream file(path, std::ios::binary);
+            CacheHeader header;
+            if (!file.read((char*)&header, sizeof(header)) || header.magic != CacheMagic || header.version != CacheFormatVersion || header.key != key)
+                return std::nullopt;
+
+            std::vector<uint8_t> payload(header.payloadSize);
+            if (!file.read((char*)payload.data(), payload.size()))
+                return std::nullopt;
+            return payload;
+        }
+
+        void writeCacheFile(const std::filesystem::path& path, uint64_t key, const std::vector<uint8_t>& payload) {
+            std::error_code ec;
+            std::filesystem::create_directories(path.parent_path(), ec);
+
+            // Write beside and rename, so a crash never leaves a torn file.
+            std::filesystem::path temporary = path;
+            temporary += ".tmp";
+            {
+                std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+                CacheHeader header = { CacheMagic, CacheFormatVersion, key, payload.size() };
+                file.write((const char*)&header, sizeof(header));
+                file.write((const char*)payload.data(), payload.size());
+                if (!file) {
+                    std::println("Failed to write cache file {}", temporary.string());
+                    return;
+                }
+            }
+            std::filesystem::rename(temporary, path, ec);
+        }
+
+        struct Writer {
+            std::vector<uint8_t> bytes;
+
+            void write(const void* data, size_t size) {
+                bytes.insert(bytes.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+            }
+
+            template<typename T>
+            void write(const T& value) { write(&value, sizeof(T)); }
+        };
+
+        struct Reader {
+            const std::vector<uint8_t>& bytes;
+            size_t offset = 0;
+
+            bool read(void* data, size_t size) {
+                if (size > bytes.size() - offset)
+                    return false;
+                std::memcpy(data, bytes.data() + offset, size);
+                offset += size;
+                return true;
+            }
+
+            template<typename T>
+            bool read(T& value) { return read(&value, sizeof(T)); }
+        };
+
+        float millisecondsSince(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        BinaryCacheStats s_ProgramStats;
+        BinaryCacheStats s_FontAtlasStats;
+    }
+
+    uint32_t ProgramCache::GetOrLink(std::string_view name, std::initializer_list<std::string_view> sources, const std::function<uint32_t()>& link) {
+        auto start = std::chrono::steady_clock::now();
+
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        if (!formatCount) {
+            s_ProgramStats.misses++;
+            GLuint program = link();
+            s_ProgramStats.milliseconds += millisecondsSince(start);
+            return program;
+        }
+
+        // Binaries are only valid for the exact driver that produced them.
+        Hasher hasher;
+        for (GLenum driverString : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+            hasher.add(std::string_view((const char*)glGetString(driverString)));
+        for (std::string_view source : sources)
+            hasher.add(source);
+
+        std::filesystem::path path = s_CacheDirectory / std::format("{}.glbin", name);
+        if (auto payload = readCacheFile(path, hasher.value); payload && payload->size() > sizeof(GLenum)) {
+            GLenum format;
+            std::memcpy(&format, payload->data(), sizeof(format));
+
+            GLuint program = glCreateProgram();
+            glProgramBinary(program, format, payload->data() + sizeof(format), (GLsizei)(payload->size() - sizeof(format)));
+            GLint status = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &status);
+            if (status) {
+                s_ProgramStats.hits++;
+                s_ProgramStats.milliseconds += millisecondsSince(start);
+                return program;
+            }
+            glDeleteProgram(program);
+            s_ProgramStats.rejected++;
+        }
+
+        s_ProgramStats.misses++;
+        GLuint program = link();
+        if (program) {
+            GLint length = 0;
+            glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+            if (length > 0) {
+                std::vector<uint8_t> payload(sizeof(GLenum) + length);
+                GLenum format = 0;
+                glGetProgramBinary(program, length, &length, &format, payload.data() + sizeof(format));
+                std::memcpy(payload.data(), &format, sizeof(format));
+                payload.resize(sizeof(format) + length);
+                writeCacheFile(path, hasher.value, payload);
+            }
+        }
+        s_ProgramStats.milliseconds += millisecondsSince(start);
+        return program;
+    }
+
+    const BinaryCacheStats& ProgramCache::GetStats() {
+        return s_ProgramStats;
+    }
+
+#if IMGUI_VERSION_NUM < 19200
+    namespace {
+        uint64_t getFontAtlasKey(const ImFontAtlas& atlas) {
+            Hasher hasher;
+            hasher.add(IMGUI_VERSION_NUM);
+            hasher.add(sizeof(ImFontGlyph));
+            hasher.add(sizeof(ImFontAtlasCustomRect));
+            hasher.add(atlas.Flags);
+            hasher.add(atlas.TexDesiredWidth);
+            hasher.add(atlas.TexGlyphPadding);
+            for (const ImFontConfig& config : atlas.ConfigData) {
+                hasher.add(config.FontData, config.FontDataSize);
+                hasher.add(config.FontNo);
+                hasher.add(config.SizePixels);
+                hasher.add(config.OversampleH);
+                hasher.add(config.OversampleV);
+                hasher.add(config.PixelSnapH);
+                hasher.add(config.GlyphOffset);
+                hasher.add(config.GlyphMinAdvanceX);
+                hasher.add(config.GlyphMaxAdvanceX);
+                hasher.add(config.MergeMode);
+                hasher.add(config.FontBuilderFlags);
+                hasher.add(config.RasterizerMultiply);
+                hasher.add(config.EllipsisChar);
+                for (const ImWchar* range = config.GlyphRanges; range && *range; range++)
+                    hasher.add(*range);
+            }
+            return hasher.value;
+        }
+
+        std::vector<uint8_t> saveFontAtlas(ImFontAtlas& atlas) {
+            unsigned char* pixels;
+            int width, height;
+            atlas.GetTexDataAsAlpha8(&pixels, &width, &height);
+
+            Writer writer;
+            writer.write(width);
+            writer.write(height);
+            writer.write(atlas.TexUvScale);
+            writer.write(atlas.TexUvWhitePixel);
+            writer.write(atlas.TexUvLines);
+            writer.write(atlas.PackIdMouseCursors);
+            writer.write(atlas.PackIdLines);
+            writer.write(atlas.CustomRects.Size);
+            for (ImFontAtlasCustomRect rect : atlas.CustomRects) {
+                rect.Font = nullptr;
+                writer.write(rect);
+            }
+            writer.write(pixels, (size_t)width * height);
+
+            writer.write(atlas.Fonts.Size);
+            for (const ImFont* font : atlas.Fonts) {
+                writer.write(font->FontSize);
+                writer.write(font->Ascent);
+                writer.write(font->Descent);
+                writer.write(font->MetricsTotalSurface);
+                writer.write(font->Glyphs.Size);
+                writer.write(font->Glyphs.Data, font->Glyphs.Size * sizeof(ImFontGlyph));
+            }
+            return std::move(writer.bytes);
+        }
+
+        bool loadFontAtlas(ImFontAtlas& atlas, const std::vector<uint8_t>& payload) {
+            Reader reader{ payload };
+            int width, height, rectCount, fontCount;
+            ImVec2 uvScale, uvWhitePixel;
+            decltype(atlas.TexUvLines) uvLines;
+            int packIdMouseCursors, packIdLines;
+            if (!reader.read(width) || !reader.read(height) || width <= 0 || height <= 0 || !reader.read(uvScale) || !reader.read(uvWhitePixel) ||
+                !reader.read(uvLines) || !reader.read(packIdMouseCursors) || !reader.read(packIdLines) || !reader.read(rectCount) || rectCount < 0)
+                return false;
+
+            ImVector<ImFontAtlasCustomRect> rects;
+            rects.resize(rectCount);
+            if (!reader.read(rects.Data, rectCount * sizeof(ImFontAtlasCustomRect)))
+                return false;
+
+            std::vector<uint8_t> pixels((size_t)width * height);
+            if (!reader.read(pixels.data(), pixels.size()) || !reader.read(fontCount) || fontCount != atlas.Fonts.Size)
+                return false;
+
+            struct FontData {
+                float size, ascent, descent;
+                int surface;
+                ImVector<ImFontGlyph> glyphs;
+            };
+            std::vector<FontData> fonts(fontCount);
+            for (FontData& font : fonts) {
+                int glyphCount;
+                if (!reader.read(font.size) || !reader.read(font.ascent) || !reader.read(font.descent) || !reader.read(font.surface) ||
+                    !reader.read(glyphCount) || glyphCount <= 0)
+                    return false;
+                font.glyphs.resize(glyphCount);
+                if (!reader.read(font.glyphs.Data, glyphCount * sizeof(ImFontGlyph)))
+                    return false;
+            }
+
+            // Everything validated; now do what ImFontAtlas::Build() would have.
+            atlas.ClearTexData();
+            atlas.TexPixelsAlpha8 = (unsigned char*)IM_ALLOC(pixels.size());
+            std::memcpy(atlas.TexPixelsAlpha8, pixels.data(), pixels.size());
+            atlas.TexWidth = width;
+            atlas.TexHeight = height;
+            atlas.TexUvScale = uvScale;
+            atlas.TexUvWhitePixel = uvWhitePixel;
+            std::memcpy(atlas.TexUvLines, uvLines, sizeof(uvLines));
+            atlas.CustomRects.swap(rects);
+            atlas.PackIdMouseCursors = packIdMouseCursors;
+            atlas.PackIdLines = packIdLines;
+
+            for (int i = 0; i < fontCount; i++) {
+                ImFont* font = atlas.Fonts[i];
+                font->ContainerAtlas = &atlas;
+                font->FontSize = fonts[i].size;
+                font->Ascent = fonts[i].ascent;
+                font->Descent = fonts[i].descent;
+                font->MetricsTotalSurface = fonts[i].surface;
+                font->Glyphs.swap(fonts[i].glyphs);
+                font->BuildLookupTable();
+            }
+            atlas.TexReady = true;
+            return true;
+        }
+    }
+
+    void FontAtlasCache::LoadOrBuild(ImFontAtlas& atlas) {
+        auto start = std::chrono::steady_clock::now();
+        if (atlas.ConfigData.empty())
+            atlas.AddFontDefault();
+
+        // Custom glyph rects point at fonts and cannot be restored.
+        bool cacheable = true;
+        for (const ImFontAtlasCustomRect& rect : atlas.CustomRects)
+            cacheable &= !rect.Font;
+
+        uint64_t key = getFontAtlasKey(atlas);
+        std::filesystem::path path = s_CacheDirectory / "fontAtlas.bin";
+        if (cacheable) {
+            if (auto payload = readCacheFile(path, key)) {
+                if (loadFontAtlas(atlas, *payload)) {
+                    s_FontAtlasStats.hits++;
+                    s_FontAtlasStats.milliseconds += millisecondsSince(start);
+                    return;
+                }
+                s_FontAtlasStats.rejected++;
+            }
+        }
+
+        s_FontAtlasStats.misses++;
+        atlas.Build();
+        if (cacheable)
+            writeCacheFile(path, key, saveFontAtlas(atlas));
+        s_FontAtlasStats.milliseconds += millisecondsSince(start);
+    }
+#else
+    // ImGui 1.92 bakes glyphs on demand into a growing atlas, so there is
+    // nothing complete to persist at startup.
+    void FontAtlasCache::LoadOrBuild(ImFontAtlas& atlas) {
+        if (atlas.Sources.empty())
+            atlas.AddFontDefault();
+    }
+#endif
+
+    const BinaryCacheStats& FontAtlasCache::GetStats() {
+        return s_FontAtlasStats;
+    }
+
+} // namespace vica
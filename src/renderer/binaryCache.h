@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string_view>
+
+struct ImFontAtlas;
+
+namespace vica {
+    // Startup caches under cache/. Each file starts with a key hashed from
+    // everything that produced it (driver strings, shader sources, ImGui
+    // version and font config); a stale or corrupt file is rebuilt in place.
+    struct BinaryCacheStats {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t rejected = 0; // present but refused, e.g. after a driver update
+        float milliseconds = 0.0f;
+    };
+
+    class ProgramCache {
+    public:
+        // Returns the program from its cached binary when the driver accepts
+        // it; otherwise calls link(), which must return a linked program (or
+        // 0) built with GL_PROGRAM_BINARY_RETRIEVABLE_HINT, and stores it.
+        static uint32_t GetOrLink(std::string_view name, std::initializer_list<std::string_view> sources, const std::function<uint32_t()>& link);
+
+        static const BinaryCacheStats& GetStats();
+    };
+
+    class FontAtlasCache {
+    public:
+        // Call after adding fonts and before anything builds the atlas.
+        // Restores the baked texture and glyph tables, or builds the atlas
+        // and writes them out for the next start.
+        static void LoadOrBuild(ImFontAtlas& atlas);
+
+        static const BinaryCacheStats& GetStats();
+    };
+
+} // namespace vica
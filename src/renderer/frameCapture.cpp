@@ -0,0 +1,254 @@
+#include "frameCapture.h"
+#include "debug/profiler.h"
+
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <print>
+
+#include <glad/glad.h>
+#include <zlib.h>
+
+namespace vica {
+
+    namespace {
+        void writeBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+            out.push_back((uint8_t)(value >> 24));
+            out.push_back((uint8_t)(value >> 16));
+            out.push_back((uint8_t)(value >> 8));
+            out.push_back((uint8_t)value);
+        }
+
+        void writeChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data) {
+            std::vector<uint8_t> chunk;
+            writeBigEndian(chunk, (uint32_t)data.size());
+            chunk.insert(chunk.end(), type, type + 4);
+            chunk.insert(chunk.end(), data.begin(), data.end());
+            writeBigEndian(chunk, (uint32_t)crc32(0, chunk.data() + 4, (uInt)(chunk.size() - 4)));
+            file.write((const char*)chunk.data(), chunk.size());
+        }
+
+        // RGBA8 PNG, every row with the Sub filter (flat UI areas become
+        // runs of zeros) and zlib at its fastest level, so the capture worker
+        // keeps up while files stay a fraction of the raw size.
+        bool writePNG(const std::filesystem::path& path, const uint8_t* pixels, uint32_t width, uint32_t height) {
+            std::ofstream file(path, std::ios::binary);
+            if (!file)
+                return false;
+
+            static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+            file.write((const char*)signature, sizeof(signature));
+
+            std::vector<uint8_t> header;
+            writeBigEndian(header, width);
+            writeBigEndian(header, height);
+            header.insert(header.end(), { 8, 6, 0, 0, 0 }); // 8-bit RGBA, deflate, adaptive filtering, no interlace
+            writeChunk(file, "IHDR", header);
+
+            size_t stride = (size_t)width * 4;
+            size_t rawSize = (stride + 1) * height;
+            std::vector<uint8_t> raw(rawSize);
+            for (uint32_t y = 0; y < height; y++) {
+                const uint8_t* src = pixels + y * stride;
+                uint8_t* dst = &raw[y * (stride + 1)];
+                dst[0] = 1; // Sub
+                std::memcpy(dst + 1, src, 4);
+                for (size_t i = 4; i < stride; i++)
+                    dst[1 + i] = (uint8_t)(src[i] - src[i - 4]);
+            }
+
+            uLongf zlibSize = compressBound((uLong)rawSize);
+            std::vector<uint8_t> zlib(zlibSize);
+            if (compress2(zlib.data(), &zlibSize, raw.data(), (uLong)rawSize, Z_BEST_SPEED) != Z_OK)
+                return false;
+            zlib.resize(zlibSize);
+
+            writeChunk(file, "IDAT", zlib);
+            writeChunk(file, "IEND", {});
+            return (bool)file;
+        }
+    }
+
+    void FrameCapture::init(uint32_t ringSize, size_t maxQueuedBytes) {
+        m_Slots.resize(std::max(ringSize, 1u));
+        for (Slot& slot : m_Slots)
+            glCreateBuffers(1, &slot.buffer);
+
+        m_MaxQueuedBytes = maxQueuedBytes;
+        m_Stopping = false;
+        m_Worker = std::thread([this] {
+            Profiler::setThreadName("Capture");
+            workerLoop();
+            });
+    }
+
+    void FrameCapture::shutdown() {
+        if (m_Slots.empty())
+            return;
+
+        collect(true);
+        for (Slot& slot : m_Slots)
+            glDeleteBuffers(1, &slot.buffer);
+        m_Slots.clear();
+
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_JobAvailable.notify_all();
+        m_Worker.join();
+    }
+
+    void FrameCapture::requestScreenshot(const std::filesystem::path& path) {
+        m_ScreenshotPath = path;
+        m_ScreenshotRequested = true;
+    }
+
+    void FrameCapture::startRecording(const std::filesystem::path& directory, Format format) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        m_RecordingDirectory = directory;
+        m_RecordingFormat = format;
+        m_RecordingFrame = 0;
+        m_Recording = true;
+    }
+
+    void FrameCapture::stopRecording() {
+        m_Recording = false;
+    }
+
+    FrameCapture::Stats FrameCapture::getStats() {
+        std::lock_guard lock(m_Mutex);
+        return m_Stats;
+    }
+
+    void FrameCapture::onFrameEnd(uint32_t width, uint32_t height) {
+        if (m_Slots.empty())
+            return;
+
+        collect(false);
+
+        if (!m_ScreenshotRequested && !m_Recording)
+            return;
+        if (!width || !height)
+            return;
+
+        if (m_Pending == m_Slots.size()) {
+            std::lock_guard lock(m_Mutex);
+            m_Stats.droppedRingFull++;
+            return;
+        }
+
+        Slot& slot = m_Slots[m_NextSlot];
+        size_t size = (size_t)width * height * 4;
+        if (slot.capacity < size) {
+            glNamedBufferData(slot.buffer, size, nullptr, GL_STREAM_READ);
+            slot.capacity = size;
+        }
+
+        if (m_ScreenshotRequested) {
+            slot.path = m_ScreenshotPath;
+            if (slot.path.empty())
+                slot.path = std::format("screenshot_{:%Y%m%d_%H%M%S}.png", std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+            slot.format = Format::PNG;
+            m_ScreenshotRequested = false;
+        }
+        else {
+            const char* extension = m_RecordingFormat == Format::PNG ? "png" : "rgba";
+            char name[64];
+            std::snprintf(name, sizeof(name), "frame_%06llu_%ux%u.%s", (unsigned long long)m_RecordingFrame++, width, height, extension);
+            slot.path = m_RecordingDirectory / name;
+            slot.format = m_RecordingFormat;
+        }
+        slot.width = width;
+        slot.height = height;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadBuffer(GL_BACK);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        m_NextSlot = (m_NextSlot + 1) % m_Slots.size();
+        m_Pending++;
+    }
+
+    void FrameCapture::collect(bool wait) {
+        while (m_Pending) {
+            Slot& slot = m_Slots[(m_NextSlot + m_Slots.size() - m_Pending) % m_Slots.size()];
+            GLsync fence = (GLsync)slot.fence;
+
+            GLenum result = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000 : 0);
+            if (result == GL_TIMEOUT_EXPIRED && !wait)
+                break;
+            glDeleteSync(fence);
+            slot.fence = nullptr;
+            m_Pending--;
+
+            size_t size = (size_t)slot.width * slot.height * 4;
+            {
+                std::lock_guard lock(m_Mutex);
+                if (m_Stats.queuedBytes + size > m_MaxQueuedBytes) {
+                    m_Stats.droppedQueueFull++;
+                    continue;
+                }
+                m_Stats.captured++;
+                m_Stats.queuedBytes += size;
+            }
+
+            Job job{ std::vector<uint8_t>(size), slot.width, slot.height, slot.path, slot.format };
+            if (const void* data = glMapNamedBufferRange(slot.buffer, 0, size, GL_MAP_READ_BIT)) {
+                std::memcpy(job.pixels.data(), data, size);
+                glUnmapNamedBuffer(slot.buffer);
+            }
+
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Jobs.push_back(std::move(job));
+            }
+            m_JobAvailable.notify_one();
+        }
+    }
+
+    void FrameCapture::workerLoop() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock lock(m_Mutex);
+                m_JobAvailable.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+                if (m_Jobs.empty())
+                    return;
+                job = std::move(m_Jobs.front());
+                m_Jobs.pop_front();
+            }
+
+            // GL reads bottom-up.
+            size_t stride = (size_t)job.width * 4;
+            std::vector<uint8_t> row(stride);
+            for (uint32_t y = 0; y < job.height / 2; y++) {
+                uint8_t* top = job.pixels.data() + y * stride;
+                uint8_t* bottom = job.pixels.data() + (job.height - 1 - y) * stride;
+                std::memcpy(row.data(), top, stride);
+                std::memcpy(top, bottom, stride);
+                std::memcpy(bottom, row.data(), stride);
+            }
+
+            bool written;
+            if (job.format == Format::PNG)
+                written = writePNG(job.path, job.pixels.data(), job.width, job.height);
+            else
+                written = (bool)std::ofstream(job.path, std::ios::binary).write((const char*)job.pixels.data(), job.pixels.size());
+
+            if (!written)
+                std::println("Failed to write capture {}", job.path.string());
+
+            std::lock_guard lock(m_Mutex);
+            m_Stats.queuedBytes -= job.pixels.size();
+            if (written)
+                m_Stats.written++;
+        }
+    }
+
+} // namespace vica
@@ -0,0 +1,87 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vica {
+    // Reads the back buffer through a ring of pixel-pack buffers guarded by
+    // fences, so glReadPixels never stalls. Completed frames are handed to a
+    // worker thread for encoding. When the encode queue exceeds its memory
+    // budget, or every pack buffer is still in flight, frames are dropped
+    // instead of blocking rendering.
+    class FrameCapture {
+    public:
+        enum class Format {
+            PNG,
+            Raw, // tightly packed top-down RGBA8, one file per frame
+        };
+
+        struct Stats {
+            uint64_t captured = 0; // read back and queued for encoding
+            uint64_t written = 0;
+            uint64_t droppedRingFull = 0;  // every pack buffer still in flight
+            uint64_t droppedQueueFull = 0; // encode queue over its memory budget
+            size_t queuedBytes = 0;
+        };
+
+        void init(uint32_t ringSize = 3, size_t maxQueuedBytes = 256ull * 1024 * 1024);
+        void shutdown();
+
+        // Without a path the file is named screenshot_<local time>.png when taken.
+        void requestScreenshot(const std::filesystem::path& path = {});
+        void startRecording(const std::filesystem::path& directory, Format format = Format::Raw);
+        void stopRecording();
+        bool isRecording() const { return m_Recording; }
+        // A screenshot, recording or readback is waiting on onFrameEnd().
+        bool needsFrame() const { return m_Recording || m_ScreenshotRequested || m_Pending; }
+
+        // Call after the frame is rendered, before the buffer swap.
+        void onFrameEnd(uint32_t width, uint32_t height);
+
+        Stats getStats();
+    private:
+        struct Job {
+            std::vector<uint8_t> pixels;
+            uint32_t width, height;
+            std::filesystem::path path;
+            Format format;
+        };
+
+        struct Slot {
+            uint32_t buffer = 0;
+            size_t capacity = 0;
+            void* fence = nullptr;
+            uint32_t width = 0, height = 0;
+            std::filesystem::path path;
+            Format format = Format::PNG;
+        };
+
+        void collect(bool wait);
+        void workerLoop();
+    private:
+        std::vector<Slot> m_Slots;
+        uint32_t m_NextSlot = 0; // next slot to read into
+        uint32_t m_Pending = 0;  // slots in flight, ending just before m_NextSlot
+
+        std::filesystem::path m_ScreenshotPath;
+        bool m_ScreenshotRequested = false;
+
+        std::filesystem::path m_RecordingDirectory;
+        Format m_RecordingFormat = Format::Raw;
+        uint64_t m_RecordingFrame = 0;
+        bool m_Recording = false;
+
+        std::thread m_Worker;
+        std::mutex m_Mutex;
+        std::condition_variable m_JobAvailable;
+        std::deque<Job> m_Jobs;
+        size_t m_MaxQueuedBytes = 0;
+        bool m_Stopping = false;
+        Stats m_Stats;
+    };
+
+} // namespace vica
@@ -0,0 +1,80 @@
+#include "frameDamage.h"
+
+#include <cstring>
+
+#include <imgui.h>
+
+#include "debug/profiler.h"
+
+namespace vica {
+
+    namespace {
+        // Word-at-a-time multiply/xorshift mix: a demo-window frame is a few
+        // hundred KB of vertices, so this has to run near memory bandwidth.
+        struct Hasher {
+            uint64_t value = 0x243F6A8885A308D3ull;
+
+            void add(const void* data, size_t size) {
+                const uint8_t* bytes = (const uint8_t*)data;
+                for (; size >= 8; bytes += 8, size -= 8) {
+                    uint64_t word;
+                    std::memcpy(&word, bytes, 8);
+                    mix(word);
+                }
+                if (size) {
+                    uint64_t word = 0;
+                    std::memcpy(&word, bytes, size);
+                    mix(word ^ (size << 56));
+                }
+            }
+
+            template<typename T>
+            void add(const T& data) { add(&data, sizeof(T)); }
+
+            void mix(uint64_t word) {
+                value = (value ^ word) * 0x9E3779B97F4A7C15ull;
+                value ^= value >> 29;
+            }
+        };
+    }
+
+    bool FrameDamage::update(const ImDrawData* drawData, bool force) {
+        VICA_PROFILE_FUNCTION();
+        Hasher hasher;
+        hasher.add(drawData->DisplayPos);
+        hasher.add(drawData->DisplaySize);
+        hasher.add(drawData->FramebufferScale);
+        hasher.add(drawData->CmdListsCount);
+        for (int n = 0; n < drawData->CmdListsCount; n++) {
+            const ImDrawList* list = drawData->CmdLists[n];
+            hasher.add(list->VtxBuffer.Size);
+            hasher.add(list->VtxBuffer.Data, list->VtxBuffer.Size * sizeof(ImDrawVert));
+            hasher.add(list->IdxBuffer.Size);
+            hasher.add(list->IdxBuffer.Data, list->IdxBuffer.Size * sizeof(ImDrawIdx));
+            for (const ImDrawCmd& cmd : list->CmdBuffer) {
+                hasher.add(cmd.ClipRect);
+                hasher.add(cmd.GetTexID());
+                hasher.add(cmd.VtxOffset);
+                hasher.add(cmd.IdxOffset);
+                hasher.add(cmd.ElemCount);
+                hasher.add(cmd.UserCallback);
+                hasher.add(cmd.UserCallbackData);
+            }
+        }
+
+        bool changed = hasher.value != m_LastHash || m_Invalidated || force || !m_Enabled;
+        m_LastHash = hasher.value;
+        m_Invalidated = false;
+
+        if (changed) {
+            m_Stats.presented++;
+            m_Stats.skippedStreak = 0;
+        }
+        else {
+            m_Stats.skipped++;
+            m_Stats.skippedStreak++;
+        }
+        return changed;
+    }
+
+} // namespace vica
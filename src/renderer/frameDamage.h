@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+struct ImDrawData;
+
+namespace vica {
+    // Decides whether a frame has to reach the GPU. The hash covers what
+    // ImGui hands the renderer: vertices, indices, commands with their
+    // texture IDs and clip rects, and the display size. Texture contents are
+    // not part of it, so code that updates a texture in place calls
+    // invalidate().
+    class FrameDamage {
+    public:
+        struct Stats {
+            uint64_t presented = 0;
+            uint64_t skipped = 0;
+            uint64_t skippedStreak = 0; // current run of skipped frames
+        };
+
+        // Returns true when drawData differs from the last presented frame,
+        // or when invalidated, forced or disabled.
+        bool update(const ImDrawData* drawData, bool force = false);
+        void invalidate() { m_Invalidated = true; }
+
+        void setEnabled(bool enabled) { m_Enabled = enabled; }
+        bool isEnabled() const { return m_Enabled; }
+
+        const Stats& getStats() const { return m_Stats; }
+    private:
+        uint64_t m_LastHash = 0;
+        bool m_Invalidated = true;
+        bool m_Enabled = true;
+        Stats m_Stats;
+    };
+
+} // namespace vica
@@ -0,0 +1,63 @@
+#include "frameLimiter.h"
+
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include "debug/profiler.h"
+
+namespace vica {
+
+    void FrameLimiter::shutdown() {
+        for (const Frame& frame : m_Frames)
+            glDeleteSync((GLsync)frame.fence);
+        m_Frames.clear();
+    }
+
+    bool FrameLimiter::retire(bool wait) {
+        if (m_Frames.empty())
+            return false;
+
+        GLsync fence = (GLsync)m_Frames.front().fence;
+        GLenum result;
+        if (wait)
+            while ((result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000)) == GL_TIMEOUT_EXPIRED);
+        else
+            result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED)
+            return false;
+
+        float latency = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_Frames.front().inputTime).count();
+        m_Stats.latencyMilliseconds = m_Stats.latencyMilliseconds == 0.0f ? latency : m_Stats.latencyMilliseconds * 0.9f + latency * 0.1f;
+        m_History[m_HistoryOffset] = latency;
+        m_HistoryOffset = (m_HistoryOffset + 1) % HistorySize;
+        m_Stats.maxLatencyMilliseconds = *std::max_element(std::begin(m_History), std::end(m_History));
+
+        m_CompletedFrames = m_Frames.front().serial;
+        glDeleteSync(fence);
+        m_Frames.pop_front();
+        return true;
+    }
+
+    void FrameLimiter::waitForFrameSlot() {
+        VICA_PROFILE_FUNCTION();
+        // Retire whatever already finished so latency is stamped promptly.
+        while (retire(false));
+
+        auto start = std::chrono::steady_clock::now();
+        if (m_MaxFramesInFlight)
+            while (m_Frames.size() >= m_MaxFramesInFlight && retire(true));
+        float wait = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        m_Stats.waitMilliseconds = m_Stats.waitMilliseconds * 0.9f + wait * 0.1f;
+        m_Stats.framesInFlight = (uint32_t)m_Frames.size();
+    }
+
+    void FrameLimiter::onFrameSwapped(std::chrono::steady_clock::time_point inputTime) {
+        // The fence follows the swap's own commands, so it signals once the
+        // GPU has finished the frame, including any blit the swap issued.
+        m_Frames.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), ++m_SubmittedFrames, inputTime });
+        // Make sure the fence reaches the GPU even if nothing waits on it.
+        glFlush();
+    }
+
+} // namespace vica
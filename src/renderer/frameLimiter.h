@@ -0,0 +1,62 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+namespace vica {
+    // Bounds how many swapped frames the driver may queue. A fence goes in
+    // after each swap; waitForFrameSlot() blocks on the oldest one, before
+    // input is polled, so the wait never ages the input of the next frame.
+    // The same fences measure input-to-present latency: from the input poll
+    // to the point its frame's fence is seen signalled.
+    class FrameLimiter {
+    public:
+        struct Stats {
+            float latencyMilliseconds = 0.0f;  // smoothed
+            float maxLatencyMilliseconds = 0.0f; // over the history window
+            float waitMilliseconds = 0.0f;     // smoothed time blocked in waitForFrameSlot()
+            uint32_t framesInFlight = 0;
+        };
+
+        static constexpr uint32_t HistorySize = 128;
+
+        void shutdown();
+
+        // 0 leaves queueing to the driver; latency is still measured.
+        void setMaxFramesInFlight(uint32_t count) { m_MaxFramesInFlight = count; }
+        uint32_t getMaxFramesInFlight() const { return m_MaxFramesInFlight; }
+
+        // Call at the start of a frame, before polling input.
+        void waitForFrameSlot();
+        // Call right after the buffer swap with the time input was polled.
+        void onFrameSwapped(std::chrono::steady_clock::time_point inputTime);
+
+        // Swapped frames so far, and how many of those the GPU has finished.
+        // Work submitted now completes by frame getSubmittedFrames() + 1.
+        uint64_t getSubmittedFrames() const { return m_SubmittedFrames; }
+        uint64_t getCompletedFrames() const { return m_CompletedFrames; }
+
+        const Stats& getStats() const { return m_Stats; }
+        // Per-frame latencies in milliseconds, oldest first from getHistoryOffset().
+        const float* getHistory() const { return m_History; }
+        uint32_t getHistoryOffset() const { return m_HistoryOffset; }
+    private:
+        struct Frame {
+            void* fence;
+            uint64_t serial;
+            std::chrono::steady_clock::time_point inputTime;
+        };
+
+        bool retire(bool wait);
+    private:
+        std::deque<Frame> m_Frames;
+        uint32_t m_MaxFramesInFlight = 0;
+        uint64_t m_SubmittedFrames = 0;
+        uint64_t m_CompletedFrames = 0;
+
+        float m_History[HistorySize] = {};
+        uint32_t m_HistoryOffset = 0;
+        Stats m_Stats;
+    };
+
+} // namespace vica
@@ -0,0 +1,59 @@
+#include "gpuTimer.h"
+
+#include <glad/glad.h>
+
+namespace vica {
+
+    void GpuTimer::init() {
+        glCreateQueries(GL_TIME_ELAPSED, QueryCount, m_Queries);
+    }
+
+    void GpuTimer::shutdown() {
+        glDeleteQueries(QueryCount, m_Queries);
+        for (bool& pending : m_Pending)
+            pending = false;
+    }
+
+    void GpuTimer::begin() {
+        collect();
+
+        // Skip this frame rather than wait if the ring is still in flight.
+        m_Active = !m_Pending[m_Index];
+        if (m_Active)
+            glBeginQuery(GL_TIME_ELAPSED, m_Queries[m_Index]);
+    }
+
+    void GpuTimer::end() {
+        if (!m_Active)
+            return;
+
+        glEndQuery(GL_TIME_ELAPSED);
+        m_Pending[m_Index] = true;
+        m_Index = (m_Index + 1) % QueryCount;
+        m_Active = false;
+    }
+
+    void GpuTimer::collect(bool wait) {
+        for (uint32_t i = 0; i < QueryCount; i++) {
+            if (!m_Pending[i])
+                continue;
+
+            if (!wait) {
+                GLint available = GL_FALSE;
+                glGetQueryObjectiv(m_Queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available)
+                    continue;
+            }
+
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(m_Queries[i], GL_QUERY_RESULT, &nanoseconds);
+            m_Pending[i] = false;
+
+            float milliseconds = (float)nanoseconds / 1.0e6f;
+            m_Milliseconds = m_Milliseconds == 0.0f ? milliseconds : m_Milliseconds * 0.95f + milliseconds * 0.05f;
+            m_TotalMilliseconds += milliseconds;
+            m_SampleCount++;
+        }
+    }
+
+} // namespace vica
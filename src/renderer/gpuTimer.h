@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+namespace vica {
+    // GL_TIME_ELAPSED query ring. Results are read back a few frames later,
+    // only once available, so timing never stalls the pipeline.
+    class GpuTimer {
+    public:
+        void init();
+        void shutdown();
+
+        void begin();
+        void end();
+
+        // Exponentially smoothed GPU time of recent begin()/end() pairs.
+        float getMilliseconds() const { return m_Milliseconds; }
+
+        // Sum and count of every collected pair since the last resetTotals(),
+        // for benchmark runs. finish() blocks until in-flight pairs are counted.
+        double getTotalMilliseconds() const { return m_TotalMilliseconds; }
+        uint32_t getSampleCount() const { return m_SampleCount; }
+        void finish() { collect(true); }
+        void resetTotals() { m_TotalMilliseconds = 0.0; m_SampleCount = 0; }
+    private:
+        void collect(bool wait = false);
+    private:
+        static constexpr uint32_t QueryCount = 4;
+
+        uint32_t m_Queries[QueryCount] = {};
+        bool m_Pending[QueryCount] = {};
+        uint32_t m_Index = 0;
+        bool m_Active = false;
+        float m_Milliseconds = 0.0f;
+        double m_TotalMilliseconds = 0.0;
+        uint32_t m_SampleCount = 0;
+    };
+
+} // namespace vica
@@ -0,0 +1,338 @@
+#include "imGuiRenderer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <print>
+
+#include <glad/glad.h>
+#include <imgui.h>
+
+#include "binaryCache.h"
+
+namespace vica {
+
+    namespace {
+        const char* s_VertexShader = R"(#version 460 core
+layout(location = 0) in vec2 a_Position;
+layout(location = 1) in vec2 a_UV;
+layout(location = 2) in vec4 a_Color;
+
+layout(location = 0) uniform mat4 u_Projection;
+
+// Framebuffer-space clip rect (min.xy, max.xy) per indirect command,
+// indexed through the command's baseInstance.
+layout(std430, binding = 0) readonly buffer ClipRects {
+    vec4 u_ClipRects[];
+};
+
+layout(location = 0) out vec2 v_UV;
+layout(location = 1) out vec4 v_Color;
+layout(location = 2) flat out vec4 v_ClipRect;
+
+void main() {
+    v_UV = a_UV;
+    v_Color = a_Color;
+    v_ClipRect = u_ClipRects[gl_BaseInstance];
+    gl_Position = u_Projection * vec4(a_Position, 0.0, 1.0);
+}
+)";
+
+        const char* s_FragmentShader = R"(#version 460 core
+layout(location = 0) in vec2 v_UV;
+layout(location = 1) in vec4 v_Color;
+layout(location = 2) flat in vec4 v_ClipRect;
+
+layout(binding = 0) uniform sampler2D u_Texture;
+
+layout(location = 0) out vec4 o_Color;
+
+void main() {
+    if (any(lessThan(gl_FragCoord.xy, v_ClipRect.xy)) || any(greaterThanEqual(gl_FragCoord.xy, v_ClipRect.zw)))
+        discard;
+    o_Color = v_Color * texture(u_Texture, v_UV);
+}
+)";
+
+        GLuint compileShader(GLenum type, const char* source) {
+            GLuint shader = glCreateShader(type);
+            glShaderSource(shader, 1, &source, nullptr);
+            glCompileShader(shader);
+
+            GLint status = GL_FALSE;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+            if (!status) {
+                char log[1024];
+                glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+                std::println("ImGuiRenderer: shader compilation failed: {}", log);
+                glDeleteShader(shader);
+                return 0;
+            }
+            return shader;
+        }
+
+        GLuint linkProgram() {
+            GLuint vertex = compileShader(GL_VERTEX_SHADER, s_VertexShader);
+            GLuint fragment = compileShader(GL_FRAGMENT_SHADER, s_FragmentShader);
+            if (!vertex || !fragment) {
+                glDeleteShader(vertex);
+                glDeleteShader(fragment);
+                return 0;
+            }
+
+            GLuint program = glCreateProgram();
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glAttachShader(program, vertex);
+            glAttachShader(program, fragment);
+            glLinkProgram(program);
+            glDetachShader(program, vertex);
+            glDetachShader(program, fragment);
+            glDeleteShader(vertex);
+            glDeleteShader(fragment);
+
+            GLint status = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &status);
+            if (!status) {
+                char log[1024];
+                glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+                std::println("ImGuiRenderer: program link failed: {}", log);
+                glDeleteProgram(program);
+                return 0;
+            }
+            return program;
+        }
+    }
+
+    bool ImGuiRenderer::init() {
+        m_Program = ProgramCache::GetOrLink("imGuiRenderer", { s_VertexShader, s_FragmentShader }, linkProgram);
+        if (!m_Program)
+            return false;
+
+        glCreateVertexArrays(1, &m_VertexArray);
+        glEnableVertexArrayAttrib(m_VertexArray, 0);
+        glEnableVertexArrayAttrib(m_VertexArray, 1);
+        glEnableVertexArrayAttrib(m_VertexArray, 2);
+        glVertexArrayAttribFormat(m_VertexArray, 0, 2, GL_FLOAT, GL_FALSE, offsetof(ImDrawVert, pos));
+        glVertexArrayAttribFormat(m_VertexArray, 1, 2, GL_FLOAT, GL_FALSE, offsetof(ImDrawVert, uv));
+        glVertexArrayAttribFormat(m_VertexArray, 2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(ImDrawVert, col));
+        glVertexArrayAttribBinding(m_VertexArray, 0, 0);
+        glVertexArrayAttribBinding(m_VertexArray, 1, 0);
+        glVertexArrayAttribBinding(m_VertexArray, 2, 0);
+
+        createBuffers(1 << 16, 1 << 17, 1 << 10);
+
+        ImGuiIO& io = ImGui::GetIO();
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+
+        unsigned char* pixels;
+        int width, height;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_FontTexture);
+        glTextureStorage2D(m_FontTexture, 1, GL_RGBA8, width, height);
+        glTextureParameteri(m_FontTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(m_FontTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureSubImage2D(m_FontTexture, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        io.Fonts->SetTexID((ImTextureID)(intptr_t)m_FontTexture);
+
+        return true;
+    }
+
+    void ImGuiRenderer::shutdown() {
+        destroyBuffers();
+        glDeleteVertexArrays(1, &m_VertexArray);
+        glDeleteProgram(m_Program);
+        glDeleteTextures(1, &m_FontTexture);
+        m_VertexArray = m_Program = m_FontTexture = 0;
+    }
+
+    void ImGuiRenderer::createBuffers(size_t vertexCapacity, size_t indexCapacity, size_t commandCapacity) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        m_VertexCapacity = vertexCapacity;
+        m_IndexCapacity = indexCapacity;
+        m_CommandCapacity = commandCapacity;
+
+        size_t vertexBytes = SegmentCount * m_VertexCapacity * sizeof(ImDrawVert);
+        size_t indexBytes = SegmentCount * m_IndexCapacity * sizeof(ImDrawIdx);
+        size_t commandBytes = SegmentCount * m_CommandCapacity * sizeof(DrawElementsIndirectCommand);
+        size_t clipRectBytes = SegmentCount * m_CommandCapacity * sizeof(ClipRect);
+
+        glCreateBuffers(1, &m_VertexBuffer);
+        glNamedBufferStorage(m_VertexBuffer, vertexBytes, nullptr, flags);
+        m_Vertices = glMapNamedBufferRange(m_VertexBuffer, 0, vertexBytes, flags);
+
+        glCreateBuffers(1, &m_IndexBuffer);
+        glNamedBufferStorage(m_IndexBuffer, indexBytes, nullptr, flags);
+        m_Indices = glMapNamedBufferRange(m_IndexBuffer, 0, indexBytes, flags);
+
+        glCreateBuffers(1, &m_IndirectBuffer);
+        glNamedBufferStorage(m_IndirectBuffer, commandBytes, nullptr, flags);
+        m_Commands = (DrawElementsIndirectCommand*)glMapNamedBufferRange(m_IndirectBuffer, 0, commandBytes, flags);
+
+        glCreateBuffers(1, &m_ClipRectBuffer);
+        glNamedBufferStorage(m_ClipRectBuffer, clipRectBytes, nullptr, flags);
+        m_ClipRects = (ClipRect*)glMapNamedBufferRange(m_ClipRectBuffer, 0, clipRectBytes, flags);
+
+        glVertexArrayVertexBuffer(m_VertexArray, 0, m_VertexBuffer, 0, sizeof(ImDrawVert));
+        glVertexArrayElementBuffer(m_VertexArray, m_IndexBuffer);
+    }
+
+    void ImGuiRenderer::destroyBuffers() {
+        for (uint32_t i = 0; i < SegmentCount; i++)
+            waitForSegment(i);
+
+        GLuint buffers[] = { m_VertexBuffer, m_IndexBuffer, m_IndirectBuffer, m_ClipRectBuffer };
+        for (GLuint buffer : buffers)
+            if (buffer)
+                glUnmapNamedBuffer(buffer);
+        glDeleteBuffers(4, buffers);
+
+        m_VertexBuffer = m_IndexBuffer = m_IndirectBuffer = m_ClipRectBuffer = 0;
+        m_Vertices = m_Indices = nullptr;
+        m_Commands = nullptr;
+        m_ClipRects = nullptr;
+    }
+
+    void ImGuiRenderer::waitForSegment(uint32_t segment) {
+        GLsync fence = (GLsync)m_Fences[segment];
+        if (!fence)
+            return;
+
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+        glDeleteSync(fence);
+        m_Fences[segment] = nullptr;
+    }
+
+    void ImGuiRenderer::setupRenderState(ImDrawData* drawData) {
+        glEnable(GL_BLEND);
+        glBlendEquation(GL_FUNC_ADD);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glDisable(GL_CULL_FACE);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_STENCIL_TEST);
+        glDisable(GL_SCISSOR_TEST); // clipping is done per draw in the fragment shader
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+        float l = drawData->DisplayPos.x;
+        float r = drawData->DisplayPos.x + drawData->DisplaySize.x;
+        float t = drawData->DisplayPos.y;
+        float b = drawData->DisplayPos.y + drawData->DisplaySize.y;
+        const float projection[4][4] = {
+            { 2.0f / (r - l),    0.0f,              0.0f, 0.0f },
+            { 0.0f,              2.0f / (t - b),    0.0f, 0.0f },
+            { 0.0f,              0.0f,             -1.0f, 0.0f },
+            { (r + l) / (l - r), (t + b) / (b - t), 0.0f, 1.0f },
+        };
+
+        glUseProgram(m_Program);
+        glProgramUniformMatrix4fv(m_Program, 0, 1, GL_FALSE, &projection[0][0]);
+        glBindVertexArray(m_VertexArray);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_ClipRectBuffer);
+    }
+
+    void ImGuiRenderer::renderDrawData(ImDrawData* drawData) {
+        int framebufferWidth = (int)(drawData->DisplaySize.x * drawData->FramebufferScale.x);
+        int framebufferHeight = (int)(drawData->DisplaySize.y * drawData->FramebufferScale.y);
+        if (framebufferWidth <= 0 || framebufferHeight <= 0 || !drawData->CmdListsCount)
+            return;
+
+        size_t commandCount = 0;
+        for (int n = 0; n < drawData->CmdListsCount; n++)
+            commandCount += drawData->CmdLists[n]->CmdBuffer.Size;
+
+        if ((size_t)drawData->TotalVtxCount > m_VertexCapacity || (size_t)drawData->TotalIdxCount > m_IndexCapacity || commandCount > m_CommandCapacity) {
+            destroyBuffers();
+            createBuffers(std::max(m_VertexCapacity, std::bit_ceil((size_t)drawData->TotalVtxCount)),
+                std::max(m_IndexCapacity, std::bit_ceil((size_t)drawData->TotalIdxCount)),
+                std::max(m_CommandCapacity, std::bit_ceil(commandCount)));
+        }
+
+        m_Segment = (m_Segment + 1) % SegmentCount;
+        waitForSegment(m_Segment);
+
+        size_t vertexBase = m_Segment * m_VertexCapacity;
+        size_t indexBase = m_Segment * m_IndexCapacity;
+        size_t commandBase = m_Segment * m_CommandCapacity;
+        auto* vertices = (ImDrawVert*)m_Vertices + vertexBase;
+        auto* indices = (ImDrawIdx*)m_Indices + indexBase;
+        DrawElementsIndirectCommand* commands = m_Commands + commandBase;
+        ClipRect* clipRects = m_ClipRects + commandBase;
+
+        setupRenderState(drawData);
+        m_Stats = { 0, 0, (uint32_t)drawData->TotalVtxCount, (uint32_t)drawData->TotalIdxCount };
+
+        ImVec2 clipOffset = drawData->DisplayPos;
+        ImVec2 clipScale = drawData->FramebufferScale;
+        constexpr GLenum indexType = sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+        GLuint boundTexture = 0;
+        size_t batchStart = 0, written = 0;
+        GLuint batchTexture = 0;
+
+        auto flush = [&]() {
+            if (written == batchStart)
+                return;
+            if (batchTexture != boundTexture) {
+                glBindTextureUnit(0, batchTexture);
+                boundTexture = batchTexture;
+            }
+            glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, (const void*)((commandBase + batchStart) * sizeof(DrawElementsIndirectCommand)),
+                (GLsizei)(written - batchStart), 0);
+            m_Stats.drawCalls++;
+            batchStart = written;
+        };
+
+        size_t listVertexOffset = 0, listIndexOffset = 0;
+        for (int n = 0; n < drawData->CmdListsCount; n++) {
+            const ImDrawList* list = drawData->CmdLists[n];
+            std::memcpy(vertices + listVertexOffset, list->VtxBuffer.Data, list->VtxBuffer.Size * sizeof(ImDrawVert));
+            std::memcpy(indices + listIndexOffset, list->IdxBuffer.Data, list->IdxBuffer.Size * sizeof(ImDrawIdx));
+
+            for (int c = 0; c < list->CmdBuffer.Size; c++) {
+                const ImDrawCmd* cmd = &list->CmdBuffer[c];
+                if (cmd->UserCallback) {
+                    flush();
+                    if (cmd->UserCallback == ImDrawCallback_ResetRenderState)
+                        setupRenderState(drawData);
+                    else
+                        cmd->UserCallback(list, cmd);
+                    boundTexture = 0;
+                    continue;
+                }
+
+                ImVec2 clipMin = { (cmd->ClipRect.x - clipOffset.x) * clipScale.x, (cmd->ClipRect.y - clipOffset.y) * clipScale.y };
+                ImVec2 clipMax = { (cmd->ClipRect.z - clipOffset.x) * clipScale.x, (cmd->ClipRect.w - clipOffset.y) * clipScale.y };
+                if (clipMax.x <= clipMin.x || clipMax.y <= clipMin.y || !cmd->ElemCount)
+                    continue;
+
+                GLuint texture = (GLuint)(intptr_t)cmd->GetTexID();
+                if (texture != batchTexture) {
+                    flush();
+                    batchTexture = texture;
+                }
+
+                // Same pixels glScissor would keep: whole pixels, origin bottom-left.
+                float x = (float)(int)clipMin.x, y = (float)(int)((float)framebufferHeight - clipMax.y);
+                clipRects[written] = { x, y, x + (float)(int)(clipMax.x - clipMin.x), y + (float)(int)(clipMax.y - clipMin.y) };
+                commands[written] = {
+                    cmd->ElemCount,
+                    1,
+                    (uint32_t)(indexBase + listIndexOffset + cmd->IdxOffset),
+                    (int32_t)(vertexBase + listVertexOffset + cmd->VtxOffset),
+                    (uint32_t)(commandBase + written)
+                };
+                written++;
+                m_Stats.commands++;
+            }
+
+            listVertexOffset += list->VtxBuffer.Size;
+            listIndexOffset += list->IdxBuffer.Size;
+        }
+        flush();
+
+        m_Fences[m_Segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+} // namespace vica
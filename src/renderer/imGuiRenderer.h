@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+struct ImDrawData;
+
+namespace vica {
+    enum class ImGuiRendererBackend {
+        Stock, // imgui_impl_opengl3
+        Vica,
+    };
+
+    // GL 4.6 renderer for ImGui draw data. Vertices, indices and indirect
+    // commands are written into triple-buffered, persistently mapped rings,
+    // and consecutive commands sharing a texture are submitted with a single
+    // glMultiDrawElementsIndirect. Clip rects go into a parallel ring that the
+    // fragment shader reads through each command's baseInstance, so a clip
+    // change never splits a batch.
+    class ImGuiRenderer {
+    public:
+        struct Stats {
+            uint32_t commands = 0;
+            uint32_t drawCalls = 0;
+            uint32_t vertices = 0;
+            uint32_t indices = 0;
+        };
+
+        bool init();
+        void shutdown();
+        void renderDrawData(ImDrawData* drawData);
+
+        const Stats& getStats() const { return m_Stats; }
+    private:
+        struct DrawElementsIndirectCommand {
+            uint32_t count;
+            uint32_t instanceCount;
+            uint32_t firstIndex;
+            int32_t baseVertex;
+            uint32_t baseInstance;
+        };
+
+        struct ClipRect {
+            float minX, minY, maxX, maxY;
+        };
+
+        void createBuffers(size_t vertexCapacity, size_t indexCapacity, size_t commandCapacity);
+        void destroyBuffers();
+        void waitForSegment(uint32_t segment);
+        void setupRenderState(ImDrawData* drawData);
+    private:
+        static constexpr uint32_t SegmentCount = 3;
+
+        uint32_t m_Program = 0;
+        uint32_t m_VertexArray = 0;
+        uint32_t m_FontTexture = 0;
+
+        uint32_t m_VertexBuffer = 0, m_IndexBuffer = 0, m_IndirectBuffer = 0, m_ClipRectBuffer = 0;
+        void* m_Vertices = nullptr;
+        void* m_Indices = nullptr;
+        DrawElementsIndirectCommand* m_Commands = nullptr;
+        ClipRect* m_ClipRects = nullptr; // one per command
+        size_t m_VertexCapacity = 0, m_IndexCapacity = 0, m_CommandCapacity = 0; // per segment
+
+        void* m_Fences[SegmentCount] = {};
+        uint32_t m_Segment = 0;
+
+        Stats m_Stats;
+    };
+
+} // namespace vica
@@ -0,0 +1,114 @@
+#include "texturePool.h"
+
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include "frameLimiter.h"
+
+namespace vica {
+
+    size_t TextureDesc::getMemorySize() const {
+        size_t bytesPerPixel = internalFormat == GL_RGBA16F ? 8 : 4;
+        size_t size = 0;
+        for (uint32_t level = 0; level < levels; level++)
+            size += (size_t)std::max(1u, width >> level) * std::max(1u, height >> level) * bytesPerPixel;
+        return size;
+    }
+
+    size_t TexturePool::DescHash::operator()(const TextureDesc& desc) const {
+        uint64_t key = ((uint64_t)desc.width << 32 | desc.height) * 0x9E3779B97F4A7C15ull;
+        return (size_t)(key ^ ((uint64_t)desc.internalFormat << 8 | desc.levels));
+    }
+
+    void TexturePool::init(const FrameLimiter& frames, size_t maxPooledBytes) {
+        m_Frames = &frames;
+        m_MaxPooledBytes = maxPooledBytes;
+    }
+
+    void TexturePool::shutdown() {
+        for (auto& [desc, textures] : m_Available)
+            glDeleteTextures((GLsizei)textures.size(), textures.data());
+        for (const Released& released : m_Pending)
+            glDeleteTextures(1, &released.texture);
+        m_Available.clear();
+        m_Pending.clear();
+        m_Stats.pending = m_Stats.available = 0;
+        m_Stats.availableBytes = 0;
+        m_Shutdown = true;
+    }
+
+    uint32_t TexturePool::acquire(const TextureDesc& desc) {
+        m_Stats.requests++;
+        if (auto it = m_Available.find(desc); it != m_Available.end() && !it->second.empty()) {
+            uint32_t texture = it->second.back();
+            it->second.pop_back();
+            m_Stats.hits++;
+            m_Stats.available--;
+            m_Stats.availableBytes -= desc.getMemorySize();
+
+            glTextureParameteri(texture, GL_TEXTURE_BASE_LEVEL, 0);
+            glTextureParameteri(texture, GL_TEXTURE_MAX_LEVEL, 1000);
+            return texture;
+        }
+
+        GLuint texture;
+        glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+        glTextureStorage2D(texture, desc.levels, desc.internalFormat, desc.width, desc.height);
+        return texture;
+    }
+
+    void TexturePool::release(uint32_t texture, const TextureDesc& desc) {
+        if (!texture)
+            return;
+        if (m_Shutdown || !m_Frames) {
+            glDeleteTextures(1, &texture);
+            return;
+        }
+
+        // Everything that could still sample it is finished by the next fence.
+        m_Pending.push_back({ texture, desc, m_Frames->getSubmittedFrames() + 1 });
+        m_Stats.pending = (uint32_t)m_Pending.size();
+    }
+
+    void TexturePool::collect() {
+        if (!m_Frames)
+            return;
+
+        uint64_t completed = m_Frames->getCompletedFrames();
+        while (!m_Pending.empty() && m_Pending.front().frame <= completed) {
+            const Released& released = m_Pending.front();
+            m_Available[released.desc].push_back(released.texture);
+            m_Stats.available++;
+            m_Stats.availableBytes += released.desc.getMemorySize();
+            m_Pending.pop_front();
+        }
+        m_Stats.pending = (uint32_t)m_Pending.size();
+
+        if (m_Stats.availableBytes > m_MaxPooledBytes)
+            trim();
+    }
+
+    void TexturePool::trim() {
+        // Largest textures go first; they free the most for the least reuse.
+        std::vector<std::pair<const TextureDesc*, std::vector<uint32_t>*>> buckets;
+        for (auto& [desc, textures] : m_Available)
+            if (!textures.empty())
+                buckets.emplace_back(&desc, &textures);
+        std::sort(buckets.begin(), buckets.end(), [](const auto& a, const auto& b) { return a.first->getMemorySize() > b.first->getMemorySize(); });
+
+        for (auto [desc, textures] : buckets) {
+            while (!textures->empty() && m_Stats.availableBytes > m_MaxPooledBytes) {
+                glDeleteTextures(1, &textures->back());
+                textures->pop_back();
+                m_Stats.available--;
+                m_Stats.availableBytes -= desc->getMemorySize();
+                m_Stats.evicted++;
+            }
+            if (m_Stats.availableBytes <= m_MaxPooledBytes)
+                break;
+        }
+        std::erase_if(m_Available, [](const auto& pair) { return pair.second.empty(); });
+    }
+
+} // namespace vica
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace vica {
+    class FrameLimiter;
+
+    // Immutable storage is fixed at creation, so a texture can only be
+    // reused for another texture with the same shape.
+    struct TextureDesc {
+        uint32_t width = 0, height = 0;
+        uint32_t internalFormat = 0;
+        uint32_t levels = 1;
+
+        // Drivers pad RGB8 to four bytes per texel.
+        size_t getMemorySize() const;
+        bool operator==(const TextureDesc& other) const = default;
+    };
+
+    // Recycles GL_TEXTURE_2D objects with immutable storage, bucketed by
+    // TextureDesc. A released texture may still be read by frames the GPU
+    // has not finished, so it only becomes reusable once the FrameLimiter
+    // reports the frame it was released in as complete.
+    class TexturePool {
+    public:
+        struct Stats {
+            uint64_t requests = 0;
+            uint64_t hits = 0;
+            uint32_t pending = 0;     // released, waiting on in-flight frames
+            uint32_t available = 0;   // ready for reuse
+            size_t availableBytes = 0;
+            uint64_t evicted = 0;     // deleted to stay within the budget
+        };
+
+        void init(const FrameLimiter& frames, size_t maxPooledBytes = 256ull * 1024 * 1024);
+        // Deletes every pooled texture; later releases delete immediately.
+        void shutdown();
+
+        // Texture parameters other than the level range are left as the
+        // previous user set them; contents are undefined.
+        uint32_t acquire(const TextureDesc& desc);
+        void release(uint32_t texture, const TextureDesc& desc);
+
+        // Once per frame: makes textures from completed frames reusable and
+        // trims the pool to its budget.
+        void collect();
+
+        void setMaxPooledBytes(size_t bytes) { m_MaxPooledBytes = bytes; }
+        const Stats& getStats() const { return m_Stats; }
+    private:
+        struct DescHash {
+            size_t operator()(const TextureDesc& desc) const;
+        };
+
+        struct Released {
+            uint32_t texture;
+            TextureDesc desc;
+            uint64_t frame; // reusable once this frame has completed
+        };
+
+        void trim();
+    private:
+        const FrameLimiter* m_Frames = nullptr;
+        std::unordered_map<TextureDesc, std::vector<uint32_t>, DescHash> m_Available;
+        std::deque<Released> m_Pending;
+        size_t m_MaxPooledBytes = 0;
+        bool m_Shutdown = false;
+        Stats m_Stats;
+    };
+
+} // namespace vica
@@ -1,40 +1,46 @@
 #include "scene.h"
 #include <GLFW/glfw3.h>
 #include "application.h"
+#include "memory/allocationTracker.h"
+#include "debug/profiler.h"
 #include <print>
 #include <imgui.h>
 
 namespace vica {
 
-    void SceneLibrary::add(Ref<Scene> scene) {
-        if (m_Scenes.find(scene->getName()) == m_Scenes.end()) {
-            m_Scenes.emplace(scene->getName(), scene);
-            if (!m_ActiveScene)
-                m_ActiveScene = scene;
-        }
+    SceneHandle SceneLibrary::add(Ref<Scene> scene) {
+        SceneHandle handle = m_Scenes.add(scene->getName(), scene);
+        if (!m_Scenes.contains(m_ActiveScene))
+            m_ActiveScene = handle;
+        return handle;
     }
 
-    void SceneLibrary::show(const std::string& name) {
-        if (m_Scenes.find(name) != m_Scenes.end()) {
-            m_ActiveScene = m_Scenes[name];
+    void SceneLibrary::show(SceneHandle handle) {
+        VICA_PROFILE_FUNCTION();
+        Scene* scene = m_Scenes.get(handle);
+        if (!scene)
+            return;
 
-            auto& app = Application::Get();
-            GLFWwindow* window = app.getWindowHandle();
-            if (app.getWindowHandle()) {
+        m_ActiveScene = handle;
 
-                if (!m_ActiveScene->isResizable()) {
-                    glfwSetWindowAttrib(window, GLFW_RESIZABLE, GLFW_FALSE);
-                    glfwSetWindowSize(window, m_ActiveScene->getWidth(), m_ActiveScene->getHeight());
-                }
-                else
-                    glfwSetWindowAttrib(window, GLFW_RESIZABLE, GLFW_TRUE);
+        auto& app = Application::Get();
+        GLFWwindow* window = app.getWindowHandle();
+        if (app.getWindowHandle()) {
 
-                glfwSetWindowTitle(window, m_ActiveScene->getName().append(" - ").append(app.getSpecs().name).c_str());
+            if (!scene->isResizable()) {
+                glfwSetWindowAttrib(window, GLFW_RESIZABLE, GLFW_FALSE);
+                glfwSetWindowSize(window, scene->getWidth(), scene->getHeight());
             }
+            else
+                glfwSetWindowAttrib(window, GLFW_RESIZABLE, GLFW_TRUE);
+
+            std::pmr::string title(scene->getName(), app.getFrameAllocator().getResource());
+            title.append(" - ").append(app.getSpecs().name);
+            glfwSetWindowTitle(window, title.c_str());
         }
     }
 
-    void customTitleBar(Timestep ts) {
+    void customTitleBar(Timestep ts, ImageHandle& favicon) {
         ImGuiStyle& style = ImGui::GetStyle();
         ImDrawList* drawList = ImGui::GetWindowDrawList();
         auto& app = Application::Get();
@@ -61,7 +67,15 @@ namespace vica {
         ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0, 0, 0, 0));
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0, 0, 0, 0));
 
-        ImGui::ImageButton("favicon", (ImTextureID)app.getImage("fav.png")->getID(), { buttonSize * 5, buttonSize * 2 });
+        // The cached handle is an index plus a generation check; the name is
+        // only resolved again once it stops being valid.
+        Image* image = app.getImage(favicon);
+        if (!image) {
+            favicon = app.findImage("fav.png");
+            image = app.getImage(favicon);
+        }
+        if (image)
+            ImGui::ImageButton("favicon", (ImTextureID)image->getID(), { buttonSize * 5, buttonSize * 2 });
         
         ImGui::PopStyleColor(3);
 
@@ -74,15 +88,17 @@ namespace vica {
 
 
     void Scene::onUpdate(Timestep ts) {
+        VICA_ALLOC_SCOPE(AllocationTag::Scenes);
         auto& app = Application::Get();
 
         if (app.getSpecs().isInCategory(ApplicationFlag_CustomTitleBar) && m_ShowCustomeTitleBar) {
-            if (app.getCustomTitleBar())
-                app.getCustomTitleBar()(ts);
+            if (const auto& titleBar = app.getCustomTitleBar())
+                titleBar(ts);
             else
-                customTitleBar(ts);
+                customTitleBar(ts, m_Favicon);
         }
 
+        VICA_ALLOC_SCOPE(AllocationTag::User);
         onUIRender(ts);
     }
 
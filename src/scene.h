@@ -5,9 +5,11 @@
 
 #include "base.h"
 #include "timestep.h"
+#include "assetRegistry.h"
+#include "entityRegistry.h"
 
 namespace vica {
-
+    class Image;
 
     class Scene {
     public:
@@ -25,7 +27,7 @@ namespace vica {
 
         virtual void onUIRender(Timestep ts) {};
 
-        std::string getName() { return m_Name; }
+        const std::string& getName() const { return m_Name; }
         const int getHeight() const { return m_Height; }
         const int getWidth() const { return m_Width; }
 
@@ -34,24 +36,34 @@ namespace vica {
 
         const bool isResizable() const { return m_Resizable; }
 
+        EntityRegistry& getRegistry() { return m_Registry; }
+        const EntityRegistry& getRegistry() const { return m_Registry; }
+
     protected:
         bool m_Resizable;
         bool m_ShowCustomeTitleBar = false;
         std::string m_Name;
         int m_Width = 0;
         int m_Height = 0;
+        EntityRegistry m_Registry;
+        Handle<Image> m_Favicon; // custom title bar icon
     };
 
+    using SceneHandle = Handle<Scene>;
+
     class SceneLibrary {
     public:
-        void add(Ref<Scene> scene);
-        const Ref<Scene> getActiveScene() const { return m_ActiveScene; }
-        void show(const std::string& name);
+        SceneHandle add(Ref<Scene> scene);
+        Scene* getActiveScene() const { return m_Scenes.get(m_ActiveScene); }
+        SceneHandle getActiveSceneHandle() const { return m_ActiveScene; }
+        SceneHandle find(const std::string& name) const { return m_Scenes.find(name); }
+        void show(SceneHandle handle);
+        void show(const std::string& name) { show(find(name)); }
 
         inline size_t getSceneLibrarySize() const { return m_Scenes.size(); }
     private:
-        Ref<Scene> m_ActiveScene;
-        std::unordered_map<std::string, Ref<Scene>> m_Scenes;
+        SceneHandle m_ActiveScene;
+        AssetRegistry<Scene> m_Scenes;
     };
 
 } // namespace vica
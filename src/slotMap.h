@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+namespace vica {
+    // Generational handle into a SlotMap. A handle stays cheap to copy and
+    // becomes stale (rather than dangling) once its slot is reused.
+    template<typename T>
+    struct Handle {
+        static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+        uint32_t index = InvalidIndex;
+        uint32_t generation = 0;
+
+        bool isValid() const { return index != InvalidIndex; }
+        explicit operator bool() const { return isValid(); }
+        bool operator==(const Handle& other) const = default;
+    };
+
+    // Dense slot map: values live contiguously in m_Data, handles resolve
+    // through m_Slots with one index and one generation compare.
+    template<typename T, typename Tag = T>
+    class SlotMap {
+    public:
+        using HandleType = Handle<Tag>;
+
+        template<typename ... Args>
+        HandleType insert(Args&& ... args) {
+            uint32_t slotIndex;
+            if (m_FreeHead != HandleType::InvalidIndex) {
+                slotIndex = m_FreeHead;
+                m_FreeHead = m_Slots[slotIndex].dense;
+            }
+            else {
+                slotIndex = (uint32_t)m_Slots.size();
+                m_Slots.push_back({});
+            }
+
+            Slot& slot = m_Slots[slotIndex];
+            slot.dense = (uint32_t)m_Data.size();
+            m_Data.emplace_back(std::forward<Args>(args)...);
+            m_DenseToSlot.push_back(slotIndex);
+
+            return { slotIndex, slot.generation };
+        }
+
+        bool remove(HandleType handle) {
+            if (!contains(handle))
+                return false;
+
+            Slot& slot = m_Slots[handle.index];
+            uint32_t dense = slot.dense;
+            uint32_t last = (uint32_t)m_Data.size() - 1;
+
+            if (dense != last) {
+                m_Data[dense] = std::move(m_Data[last]);
+                m_DenseToSlot[dense] = m_DenseToSlot[last];
+                m_Slots[m_DenseToSlot[dense]].dense = dense;
+            }
+            m_Data.pop_back();
+            m_DenseToSlot.pop_back();
+
+            slot.generation++;
+            slot.dense = m_FreeHead;
+            m_FreeHead = handle.index;
+            return true;
+        }
+
+        bool contains(HandleType handle) const {
+            return handle.index < m_Slots.size() && m_Slots[handle.index].generation == handle.generation;
+        }
+
+        T* get(HandleType handle) {
+            return contains(handle) ? &m_Data[m_Slots[handle.index].dense] : nullptr;
+        }
+
+        const T* get(HandleType handle) const {
+            return contains(handle) ? &m_Data[m_Slots[handle.index].dense] : nullptr;
+        }
+
+        HandleType handleAt(size_t denseIndex) const {
+            uint32_t slotIndex = m_DenseToSlot[denseIndex];
+            return { slotIndex, m_Slots[slotIndex].generation };
+        }
+
+        void clear() {
+            while (!m_Data.empty())
+                remove(handleAt(m_Data.size() - 1));
+        }
+
+        size_t size() const { return m_Data.size(); }
+        bool empty() const { return m_Data.empty(); }
+
+        auto begin() { return m_Data.begin(); }
+        auto end() { return m_Data.end(); }
+        auto begin() const { return m_Data.begin(); }
+        auto end() const { return m_Data.end(); }
+    private:
+        struct Slot {
+            uint32_t dense = HandleType::InvalidIndex; // next free slot while unused
+            uint32_t generation = 0;
+        };
+
+        std::vector<T> m_Data;
+        std::vector<uint32_t> m_DenseToSlot;
+        std::vector<Slot> m_Slots;
+        uint32_t m_FreeHead = HandleType::InvalidIndex;
+    };
+
+} // namespace vica
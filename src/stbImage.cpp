@@ -0,0 +1,4 @@
+// stb_image's implementation lives in its own translation unit; everything
+// else includes the header only.
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
@@ -0,0 +1,80 @@
+#include "threadPool.h"
+
+#include <algorithm>
+#include <format>
+
+#include "debug/profiler.h"
+
+namespace vica {
+
+    ThreadPool::ThreadPool(uint32_t threadCount) {
+        if (!threadCount)
+            threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+        m_Workers.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; i++)
+            m_Workers.emplace_back([this, i] {
+                Profiler::setThreadName(std::format("Worker {}", i));
+                workerLoop();
+                });
+    }
+
+    ThreadPool::~ThreadPool() {
+        shutdown();
+    }
+
+    void ThreadPool::enqueue(std::function<void()> task) {
+        {
+            std::lock_guard lock(m_Mutex);
+            if (m_Stopping)
+                return;
+            m_Tasks.push(std::move(task));
+        }
+        m_TaskAvailable.notify_one();
+    }
+
+    void ThreadPool::wait() {
+        std::unique_lock lock(m_Mutex);
+        m_Idle.wait(lock, [this] { return m_Tasks.empty() && !m_Active; });
+    }
+
+    void ThreadPool::shutdown() {
+        {
+            std::lock_guard lock(m_Mutex);
+            if (m_Stopping)
+                return;
+            m_Stopping = true;
+        }
+        m_TaskAvailable.notify_all();
+
+        for (std::thread& worker : m_Workers)
+            worker.join();
+        m_Workers.clear();
+    }
+
+    void ThreadPool::workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(m_Mutex);
+                m_TaskAvailable.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+                if (m_Tasks.empty())
+                    return;
+
+                task = std::move(m_Tasks.front());
+                m_Tasks.pop();
+                m_Active++;
+            }
+
+            task();
+
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Active--;
+                if (m_Tasks.empty() && !m_Active)
+                    m_Idle.notify_all();
+            }
+        }
+    }
+
+} // namespace vica
@@ -0,0 +1,38 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace vica {
+    class ThreadPool {
+    public:
+        explicit ThreadPool(uint32_t threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void enqueue(std::function<void()> task);
+        // Blocks until every queued task has finished.
+        void wait();
+        // Finishes queued tasks and joins the workers; enqueue() is ignored afterwards.
+        void shutdown();
+
+        uint32_t getThreadCount() const { return (uint32_t)m_Workers.size(); }
+    private:
+        void workerLoop();
+    private:
+        std::vector<std::thread> m_Workers;
+        std::queue<std::function<void()>> m_Tasks;
+        std::mutex m_Mutex;
+        std::condition_variable m_TaskAvailable;
+        std::condition_variable m_Idle;
+        uint32_t m_Active = 0;
+        bool m_Stopping = false;
+    };
+
+} // namespace vica
@@ -0,0 +1,388 @@
+#include "tiledImage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <print>
+
+#include <glad/glad.h>
+#include <imgui.h>
+
+#include "imageDecoder.h"
+#include "fileReader.h"
+#include "application.h"
+
+namespace vica {
+
+    namespace {
+        // 2x2 box filter of rows [firstRow, firstRow + rowCount) of the next
+        // level; odd edges repeat the last source row/column.
+        template<typename RowFunc>
+        void halveRows(uint32_t srcWidth, uint32_t srcHeight, RowFunc&& srcRow, uint32_t dstWidth, uint32_t firstRow, uint32_t rowCount, uint8_t* dst) {
+            for (uint32_t y = 0; y < rowCount; y++) {
+                uint32_t dstY = firstRow + y;
+                const uint8_t* row0 = srcRow(std::min(dstY * 2, srcHeight - 1));
+                const uint8_t* row1 = srcRow(std::min(dstY * 2 + 1, srcHeight - 1));
+                for (uint32_t x = 0; x < dstWidth; x++) {
+                    uint32_t x0 = std::min(x * 2, srcWidth - 1), x1 = std::min(x * 2 + 1, srcWidth - 1);
+                    const uint8_t* a = row0 + x0 * 4;
+                    const uint8_t* b = row0 + x1 * 4;
+                    const uint8_t* c = row1 + x0 * 4;
+                    const uint8_t* d = row1 + x1 * 4;
+                    uint8_t* out = dst + ((size_t)y * dstWidth + x) * 4;
+                    for (int i = 0; i < 4; i++)
+                        out[i] = (uint8_t)((a[i] + b[i] + c[i] + d[i] + 2) / 4);
+                }
+            }
+        }
+    }
+
+    TiledImage::TiledImage(const std::filesystem::path& path, uint32_t tileSize, uint32_t maxResidentTiles)
+        : TiledImage(path, readFileBytes(path), tileSize, maxResidentTiles) {
+    }
+
+    TiledImage::TiledImage(const std::filesystem::path& path, std::vector<uint8_t> file, uint32_t tileSize, uint32_t maxResidentTiles)
+        : m_Name(path.filename().string()), m_TileSize(tileSize), m_MaxResidentTiles(std::max(maxResidentTiles, 1u)), m_File(std::move(file)) {
+        // Tile textures hold the tile plus a border texel on each side.
+        GLint maxTextureSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+        if (maxTextureSize > 2)
+            m_TileSize = std::min(m_TileSize, (uint32_t)maxTextureSize - 2);
+
+        ImageDecoder& decoder = ImageDecoder::Select(m_File);
+        ImageInfo info;
+        if (!decoder.readInfo(m_File, info) || !info.width || !info.height || !buildPyramid(info, decoder)) {
+            std::println("Failed to load tiled image {} with {}", path.string(), decoder.getName());
+            m_Levels.clear();
+            return;
+        }
+
+        // The coarsest level fits in one tile; keep it resident so there is
+        // always something to fall back on while finer tiles stream in.
+        acquireTile(getLevelCount() - 1, 0, 0, true);
+    }
+
+    TiledImage::~TiledImage() {
+        for (auto& [key, tile] : m_Resident)
+            m_FreeTextures.push_back(tile.texture);
+        if (!m_FreeTextures.empty())
+            glDeleteTextures((GLsizei)m_FreeTextures.size(), m_FreeTextures.data());
+    }
+
+    bool TiledImage::buildPyramid(const ImageInfo& info, ImageDecoder& decoder) {
+        m_Width = info.width;
+        m_Height = info.height;
+
+        uint32_t width = m_Width, height = m_Height;
+        for (;;) {
+            m_Levels.push_back({ width, height, (width + m_TileSize - 1) / m_TileSize, (height + m_TileSize - 1) / m_TileSize, {} });
+            if (width <= m_TileSize && height <= m_TileSize)
+                break;
+            width = std::max(1u, (width + 1) / 2);
+            height = std::max(1u, (height + 1) / 2);
+        }
+
+        // The first level small enough to keep is built in one top-to-bottom
+        // pass over the source; the finer ones are only ever decoded by band.
+        m_FirstResidentLevel = getLevelCount() - 1;
+        for (uint32_t level = 0; level < getLevelCount(); level++)
+            if ((size_t)m_Levels[level].width * m_Levels[level].height * 4 <= MaxResidentLevelBytes) {
+                m_FirstResidentLevel = level;
+                break;
+            }
+
+        Level& first = m_Levels[m_FirstResidentLevel];
+        std::vector<uint8_t> pixels((size_t)first.width * first.height * 4);
+        if (m_FirstResidentLevel == 0) {
+            if (!decoder.decode(m_File, info, pixels, 4))
+                return false;
+            m_File = {};
+        }
+        else {
+            m_Rows = decoder.openRows(m_File, info);
+            size_t bandSize = (size_t)first.width * m_TileSize * 4;
+            for (uint32_t band = 0; band < first.tilesY; band++) {
+                Ref<std::vector<uint8_t>> rows = getBand(m_FirstResidentLevel, band);
+                if (!rows)
+                    return false;
+                std::copy(rows->begin(), rows->end(), pixels.begin() + band * bandSize);
+            }
+            m_Bands.clear();
+            m_BandLRU.clear();
+            m_Stats.cachedBandBytes = 0;
+        }
+        first.pixels = std::move(pixels);
+
+        for (uint32_t level = m_FirstResidentLevel + 1; level < getLevelCount(); level++) {
+            const Level& src = m_Levels[level - 1];
+            Level& dst = m_Levels[level];
+            dst.pixels.resize((size_t)dst.width * dst.height * 4);
+            halveRows(src.width, src.height, [&](uint32_t y) { return &src.pixels[(size_t)y * src.width * 4]; },
+                dst.width, 0, dst.height, dst.pixels.data());
+        }
+
+        for (uint32_t level = m_FirstResidentLevel; level < getLevelCount(); level++)
+            m_Stats.residentLevelBytes += m_Levels[level].pixels.size();
+        return true;
+    }
+
+    Ref<std::vector<uint8_t>> TiledImage::getBand(uint32_t level, uint32_t band) {
+        uint64_t key = makeKey(level, 0, band);
+        if (auto it = m_Bands.find(key); it != m_Bands.end()) {
+            m_BandLRU.splice(m_BandLRU.begin(), m_BandLRU, it->second.lru);
+            return it->second.pixels;
+        }
+
+        const Level& l = m_Levels[level];
+        uint32_t firstRow = band * m_TileSize;
+        uint32_t rowCount = std::min(m_TileSize, l.height - firstRow);
+        auto pixels = CreateRef<std::vector<uint8_t>>((size_t)l.width * rowCount * 4);
+
+        if (level == 0) {
+            if (!m_Rows || !m_Rows->readRows(firstRow, rowCount, *pixels))
+                return nullptr;
+        }
+        else {
+            // Band b of a level is the 2x2 reduction of bands 2b and 2b + 1 of the finer one.
+            const Level& src = m_Levels[level - 1];
+            Ref<std::vector<uint8_t>> upper = getBand(level - 1, band * 2);
+            Ref<std::vector<uint8_t>> lower = band * 2 + 1 < src.tilesY ? getBand(level - 1, band * 2 + 1) : nullptr;
+            if (!upper || (band * 2 + 1 < src.tilesY && !lower))
+                return nullptr;
+
+            uint32_t srcFirstRow = band * 2 * m_TileSize;
+            halveRows(src.width, src.height, [&](uint32_t y) {
+                uint32_t row = y - srcFirstRow;
+                return row < m_TileSize ? upper->data() + (size_t)row * src.width * 4 : lower->data() + (size_t)(row - m_TileSize) * src.width * 4;
+                }, l.width, firstRow, rowCount, pixels->data());
+        }
+        m_Stats.bandDecodes++;
+
+        m_BandLRU.push_front(key);
+        m_Bands.emplace(key, Band{ pixels, m_BandLRU.begin() });
+        m_Stats.cachedBandBytes += pixels->size();
+
+        // Callers keep their own reference, so evicting a band in use is safe.
+        // The last three stay, so a tile and its border rows never thrash.
+        while (m_Stats.cachedBandBytes > m_MaxBandBytes && m_BandLRU.size() > 3) {
+            auto victim = m_Bands.find(m_BandLRU.back());
+            m_Stats.cachedBandBytes -= victim->second.pixels->size();
+            m_Bands.erase(victim);
+            m_BandLRU.pop_back();
+        }
+        return pixels;
+    }
+
+    bool TiledImage::isBandReady(uint32_t level, uint32_t band) const {
+        return !m_Levels[level].pixels.empty() || m_Bands.contains(makeKey(level, 0, band));
+    }
+
+    uint32_t TiledImage::acquireTile(uint32_t level, uint32_t x, uint32_t y, bool allowUpload) {
+        uint64_t key = makeKey(level, x, y);
+        if (auto it = m_Resident.find(key); it != m_Resident.end()) {
+            if (it->second.lru != m_LRU.end())
+                m_LRU.splice(m_LRU.begin(), m_LRU, it->second.lru);
+            return it->second.texture;
+        }
+
+        if (!allowUpload || m_FrameUploads >= m_MaxUploadsPerFrame)
+            return 0;
+
+        // A tile reads its own band and a border row from each neighbor.
+        bool needsDecode = false;
+        for (uint32_t band = y ? y - 1 : 0; band <= std::min(y + 1, m_Levels[level].tilesY - 1); band++)
+            needsDecode |= !isBandReady(level, band);
+        if (needsDecode && m_FrameBandDecodes >= m_MaxBandDecodesPerFrame)
+            return 0;
+
+        uint32_t texture = 0;
+        if (!m_FreeTextures.empty()) {
+            texture = m_FreeTextures.back();
+            m_FreeTextures.pop_back();
+        }
+        else if (m_TextureCount < m_MaxResidentTiles) {
+            glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+            glTextureStorage2D(texture, 1, GL_RGBA8, m_TileSize + 2, m_TileSize + 2);
+            glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            m_TextureCount++;
+        }
+        else {
+            // Evict the least recently used tile. The coarsest tile is never
+            // in the LRU list, and tiles already drawn this frame are still
+            // referenced by the pending draw data.
+            if (m_LRU.empty() || m_UsedThisFrame.contains(m_LRU.back()))
+                return 0;
+
+            auto victim = m_Resident.find(m_LRU.back());
+            texture = victim->second.texture;
+            m_LRU.pop_back();
+            m_Resident.erase(victim);
+            m_Stats.evictions++;
+        }
+
+        if (needsDecode)
+            m_FrameBandDecodes++;
+        if (!uploadTile(texture, level, x, y)) {
+            m_FreeTextures.push_back(texture);
+            return 0;
+        }
+        m_FrameUploads++;
+        m_Stats.uploads++;
+
+        Tile tile{ texture, m_LRU.end() };
+        if (level != getLevelCount() - 1) {
+            m_LRU.push_front(key);
+            tile.lru = m_LRU.begin();
+        }
+        m_Resident.emplace(key, tile);
+        m_Stats.residentTiles = (uint32_t)m_Resident.size();
+        return texture;
+    }
+
+    bool TiledImage::uploadTile(uint32_t texture, uint32_t level, uint32_t x, uint32_t y) {
+        const Level& l = m_Levels[level];
+        uint32_t originX = x * m_TileSize, originY = y * m_TileSize;
+        uint32_t width = std::min(m_TileSize, l.width - originX);
+        uint32_t height = std::min(m_TileSize, l.height - originY);
+
+        // The page is the tile plus a border of the neighboring texels (the
+        // edge texel repeated at the image border), so sampling up to the tile
+        // edge blends exactly as one big texture would.
+        uint32_t pageWidth = width + 2, pageHeight = height + 2;
+        m_TilePage.resize((size_t)pageWidth * pageHeight * 4);
+
+        Ref<std::vector<uint8_t>> bands[3]; // y - 1, y, y + 1
+        for (uint32_t row = 0; row < pageHeight; row++) {
+            uint32_t sourceY = (uint32_t)std::clamp((int64_t)originY + row - 1, (int64_t)0, (int64_t)l.height - 1);
+            const uint8_t* source;
+            if (!l.pixels.empty())
+                source = &l.pixels[(size_t)sourceY * l.width * 4];
+            else {
+                uint32_t band = sourceY / m_TileSize;
+                Ref<std::vector<uint8_t>>& rows = bands[band + 1 - y];
+                if (!rows && !(rows = getBand(level, band)))
+                    return false;
+                source = rows->data() + (size_t)(sourceY - band * m_TileSize) * l.width * 4;
+            }
+
+            uint8_t* dst = &m_TilePage[(size_t)row * pageWidth * 4];
+            std::memcpy(dst, source + (size_t)(originX ? originX - 1 : 0) * 4, 4);
+            std::memcpy(dst + 4, source + (size_t)originX * 4, (size_t)width * 4);
+            std::memcpy(dst + (size_t)(width + 1) * 4, source + (size_t)std::min(originX + width, l.width - 1) * 4, 4);
+        }
+
+        glTextureSubImage2D(texture, 0, 0, 0, pageWidth, pageHeight, GL_RGBA, GL_UNSIGNED_BYTE, m_TilePage.data());
+        // Tile textures are recycled, so the same ID can now show another tile.
+        Application::Get().invalidateFrame();
+        return true;
+    }
+
+    void TiledImage::draw(ImDrawList* drawList, const ImVec2& screenMin, const ImVec2& screenMax, const ImVec2& uvMin, const ImVec2& uvMax) {
+        if (m_Levels.empty())
+            return;
+
+        int frame = ImGui::GetFrameCount();
+        if (frame != m_Frame) {
+            m_Frame = frame;
+            m_FrameUploads = 0;
+            m_FrameBandDecodes = 0;
+            m_UsedThisFrame.clear();
+        }
+
+        float screenWidth = screenMax.x - screenMin.x, screenHeight = screenMax.y - screenMin.y;
+        float uvWidth = uvMax.x - uvMin.x, uvHeight = uvMax.y - uvMin.y;
+        if (screenWidth <= 0.0f || screenHeight <= 0.0f || uvWidth <= 0.0f || uvHeight <= 0.0f)
+            return;
+
+        float scale = screenWidth / (uvWidth * m_Width);
+        uint32_t level = 0;
+        if (scale < 1.0f)
+            level = std::min(getLevelCount() - 1, (uint32_t)std::floor(std::log2(1.0f / scale)));
+
+        const Level& l = m_Levels[level];
+        float visibleU0 = std::clamp(uvMin.x, 0.0f, 1.0f), visibleU1 = std::clamp(uvMax.x, 0.0f, 1.0f);
+        float visibleV0 = std::clamp(uvMin.y, 0.0f, 1.0f), visibleV1 = std::clamp(uvMax.y, 0.0f, 1.0f);
+        if (visibleU1 <= visibleU0 || visibleV1 <= visibleV0)
+            return;
+
+        uint32_t tileX0 = std::min(l.tilesX - 1, (uint32_t)(visibleU0 * l.width) / m_TileSize);
+        uint32_t tileX1 = std::min(l.tilesX - 1, (uint32_t)std::max(0.0f, std::ceil(visibleU1 * l.width) - 1.0f) / m_TileSize);
+        uint32_t tileY0 = std::min(l.tilesY - 1, (uint32_t)(visibleV0 * l.height) / m_TileSize);
+        uint32_t tileY1 = std::min(l.tilesY - 1, (uint32_t)std::max(0.0f, std::ceil(visibleV1 * l.height) - 1.0f) / m_TileSize);
+
+        for (uint32_t ty = tileY0; ty <= tileY1; ty++) {
+            for (uint32_t tx = tileX0; tx <= tileX1; tx++) {
+                float u0 = (float)(tx * m_TileSize) / l.width;
+                float u1 = (float)std::min((tx + 1) * m_TileSize, l.width) / l.width;
+                float v0 = (float)(ty * m_TileSize) / l.height;
+                float v1 = (float)std::min((ty + 1) * m_TileSize, l.height) / l.height;
+
+                // Prefer the exact tile; otherwise sample the closest resident ancestor.
+                uint32_t texture = 0, source = level;
+                for (; source < getLevelCount() && !texture; source++)
+                    texture = acquireTile(source, tx >> (source - level), ty >> (source - level), source == level);
+                source--;
+                if (!texture)
+                    continue;
+                if (source != level)
+                    m_Stats.fallbacks++;
+
+                uint32_t sourceX = tx >> (source - level), sourceY = ty >> (source - level);
+                m_UsedThisFrame.insert(makeKey(source, sourceX, sourceY));
+
+                // Texel (tx, ty) of the tile sits at (tx + 1, ty + 1) behind the border.
+                const Level& s = m_Levels[source];
+                float pageSize = (float)(m_TileSize + 2);
+                ImVec2 texMin = { (u0 * s.width - sourceX * m_TileSize + 1.0f) / pageSize, (v0 * s.height - sourceY * m_TileSize + 1.0f) / pageSize };
+                ImVec2 texMax = { (u1 * s.width - sourceX * m_TileSize + 1.0f) / pageSize, (v1 * s.height - sourceY * m_TileSize + 1.0f) / pageSize };
+
+                ImVec2 pMin = { screenMin.x + (u0 - uvMin.x) / uvWidth * screenWidth, screenMin.y + (v0 - uvMin.y) / uvHeight * screenHeight };
+                ImVec2 pMax = { screenMin.x + (u1 - uvMin.x) / uvWidth * screenWidth, screenMin.y + (v1 - uvMin.y) / uvHeight * screenHeight };
+                drawList->AddImage((ImTextureID)(intptr_t)texture, pMin, pMax, texMin, texMax);
+            }
+        }
+    }
+
+    void TiledImage::onImGuiRender(const char* id, View& view, const ImVec2& size) {
+        ImVec2 region = size;
+        if (region.x <= 0.0f || region.y <= 0.0f) {
+            ImVec2 avail = ImGui::GetContentRegionAvail();
+            region = { region.x > 0.0f ? region.x : avail.x, region.y > 0.0f ? region.y : avail.y };
+        }
+        if (region.x <= 0.0f || region.y <= 0.0f || !m_Width || !m_Height)
+            return;
+
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImGui::InvisibleButton(id, region, ImGuiButtonFlags_MouseButtonLeft);
+
+        if (view.zoom <= 0.0f)
+            view.zoom = std::min(region.x / m_Width, region.y / m_Height);
+
+        ImGuiIO& io = ImGui::GetIO();
+        if (ImGui::IsItemHovered() && io.MouseWheel != 0.0f) {
+            // Zoom around the cursor: keep the image point under it fixed.
+            float mouseU = view.centerX + (io.MousePos.x - origin.x - region.x * 0.5f) / (view.zoom * m_Width);
+            float mouseV = view.centerY + (io.MousePos.y - origin.y - region.y * 0.5f) / (view.zoom * m_Height);
+            view.zoom = std::clamp(view.zoom * std::pow(1.2f, io.MouseWheel), 1.0f / 1024.0f, 64.0f);
+            view.centerX = mouseU - (io.MousePos.x - origin.x - region.x * 0.5f) / (view.zoom * m_Width);
+            view.centerY = mouseV - (io.MousePos.y - origin.y - region.y * 0.5f) / (view.zoom * m_Height);
+        }
+        if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left, 0.0f)) {
+            view.centerX -= io.MouseDelta.x / (view.zoom * m_Width);
+            view.centerY -= io.MouseDelta.y / (view.zoom * m_Height);
+        }
+
+        float halfU = region.x / (view.zoom * m_Width) * 0.5f;
+        float halfV = region.y / (view.zoom * m_Height) * 0.5f;
+
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        ImVec2 regionMax = { origin.x + region.x, origin.y + region.y };
+        drawList->PushClipRect(origin, regionMax, true);
+        draw(drawList, origin, regionMax, { view.centerX - halfU, view.centerY - halfV }, { view.centerX + halfU, view.centerY + halfV });
+        drawList->PopClipRect();
+    }
+
+} // namespace vica
@@ -0,0 +1,125 @@
+#pragma once
+#include <filesystem>
+#include <list>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "base.h"
+#include "slotMap.h"
+
+struct ImDrawList;
+struct ImVec2;
+
+namespace vica {
+    class ImageDecoder;
+    class ImageRowReader;
+    struct ImageInfo;
+
+    // Image split into fixed-size tiles over a mip pyramid. Only the tiles
+    // intersecting the current view at the matching mip level are uploaded,
+    // into an LRU pool of tile textures, so images larger than
+    // GL_MAX_TEXTURE_SIZE display with bounded VRAM. Only the coarse levels
+    // that fit MaxResidentLevelBytes stay in memory; finer ones are decoded
+    // from the source on demand, a band (one row of tiles) at a time, through
+    // an LRU band cache. Tile textures carry a 1-texel border of neighboring
+    // texels, so linear filtering is seamless across tiles.
+    class TiledImage {
+    public:
+        struct View {
+            float zoom = 0.0f; // screen pixels per image pixel, 0 = fit on first draw
+            float centerX = 0.5f, centerY = 0.5f; // in uv
+        };
+
+        struct Stats {
+            uint32_t residentTiles = 0;
+            uint32_t uploads = 0;
+            uint32_t evictions = 0;
+            uint32_t fallbacks = 0;
+            uint32_t bandDecodes = 0;
+            size_t cachedBandBytes = 0;
+            size_t residentLevelBytes = 0;
+        };
+
+        static constexpr size_t MaxResidentLevelBytes = 16ull * 1024 * 1024;
+
+        TiledImage(const std::filesystem::path& path, uint32_t tileSize = 256, uint32_t maxResidentTiles = 256);
+        TiledImage(const std::filesystem::path& path, std::vector<uint8_t> file, uint32_t tileSize = 256, uint32_t maxResidentTiles = 256);
+        ~TiledImage();
+
+        TiledImage(const TiledImage&) = delete;
+        TiledImage& operator=(const TiledImage&) = delete;
+
+        // Draws the uv rectangle [uvMin, uvMax] of the image into the screen rectangle [screenMin, screenMax].
+        void draw(ImDrawList* drawList, const ImVec2& screenMin, const ImVec2& screenMax, const ImVec2& uvMin, const ImVec2& uvMax);
+        // Pan (drag) and zoom (wheel) widget around draw().
+        void onImGuiRender(const char* id, View& view, const ImVec2& size);
+
+        uint32_t getWidth() const { return m_Width; }
+        uint32_t getHeight() const { return m_Height; }
+        uint32_t getTileSize() const { return m_TileSize; }
+        uint32_t getLevelCount() const { return (uint32_t)m_Levels.size(); }
+        const std::string& getName() const { return m_Name; }
+        const Stats& getStats() const { return m_Stats; }
+
+        void setMaxUploadsPerFrame(uint32_t count) { m_MaxUploadsPerFrame = count; }
+        void setMaxBandBytes(size_t bytes) { m_MaxBandBytes = bytes; }
+    private:
+        struct Level {
+            uint32_t width, height;
+            uint32_t tilesX, tilesY;
+            std::vector<uint8_t> pixels; // RGBA8; empty while the level is decoded on demand
+        };
+
+        struct Band {
+            Ref<std::vector<uint8_t>> pixels; // RGBA8, full level width
+            std::list<uint64_t>::iterator lru;
+        };
+
+        struct Tile {
+            uint32_t texture;
+            std::list<uint64_t>::iterator lru;
+        };
+
+        static uint64_t makeKey(uint32_t level, uint32_t x, uint32_t y) { return ((uint64_t)level << 48) | ((uint64_t)y << 24) | x; }
+
+        bool buildPyramid(const ImageInfo& info, ImageDecoder& decoder);
+        Ref<std::vector<uint8_t>> getBand(uint32_t level, uint32_t band);
+        bool isBandReady(uint32_t level, uint32_t band) const;
+        uint32_t acquireTile(uint32_t level, uint32_t x, uint32_t y, bool allowUpload);
+        bool uploadTile(uint32_t texture, uint32_t level, uint32_t x, uint32_t y);
+    private:
+        std::string m_Name;
+        uint32_t m_Width = 0, m_Height = 0;
+        uint32_t m_TileSize;
+        uint32_t m_MaxResidentTiles;
+        uint32_t m_MaxUploadsPerFrame = 8;
+
+        std::vector<Level> m_Levels;
+        uint32_t m_FirstResidentLevel = 0;
+
+        std::vector<uint8_t> m_File;
+        Scope<ImageRowReader> m_Rows;
+        std::unordered_map<uint64_t, Band> m_Bands;
+        std::list<uint64_t> m_BandLRU; // front = most recently used
+        size_t m_MaxBandBytes = 128ull * 1024 * 1024;
+        uint32_t m_MaxBandDecodesPerFrame = 1;
+        uint32_t m_FrameBandDecodes = 0;
+        std::vector<uint8_t> m_TilePage; // staging for one bordered tile
+
+        std::unordered_map<uint64_t, Tile> m_Resident;
+        std::list<uint64_t> m_LRU; // front = most recently used
+        std::vector<uint32_t> m_FreeTextures;
+        uint32_t m_TextureCount = 0;
+
+        std::unordered_set<uint64_t> m_UsedThisFrame;
+        int m_Frame = -1;
+        uint32_t m_FrameUploads = 0;
+        Stats m_Stats;
+    };
+
+    using TiledImageHandle = Handle<TiledImage>;
+
+} // namespace vica
@@ -0,0 +1,123 @@
+// Runs the per-frame event and ImGui paths headless and fails if any heap
+// allocation happens once the frame has warmed up. Needs VICA_TRACK_ALLOCATIONS.
+#include <algorithm>
+#include <cstdint>
+#include <print>
+#include <vector>
+
+#include <imgui.h>
+
+#include "base.h"
+#include "event/event.h"
+#include "memory/allocationTracker.h"
+#include "memory/frameAllocator.h"
+
+using namespace vica;
+
+namespace {
+
+    constexpr uint32_t WarmupFrames = 120;
+    constexpr uint32_t MeasuredFrames = 600;
+
+    struct HeadlessFrame {
+        FrameAllocator frameAllocator;
+        std::vector<Ref<Event>> eventQueue;
+        float values[64] = {};
+        uint32_t frame = 0;
+        uint32_t handled = 0;
+
+        void queueInput() {
+            ImGuiIO& io = ImGui::GetIO();
+            float x = (float)(frame % 640), y = (float)(frame % 360);
+            io.AddMousePosEvent(x, y);
+            io.AddMouseButtonEvent(0, frame % 2 == 0);
+            io.AddMouseWheelEvent(0.0f, 1.0f);
+            io.AddKeyEvent(ImGuiKey_A, frame % 2 == 0);
+
+            eventQueue.push_back(CreateFrameRef<MouseMovedEvent>(frameAllocator, x, y));
+            eventQueue.push_back(CreateFrameRef<MouseButtonPressedEvent>(frameAllocator, (MouseButton)0));
+            eventQueue.push_back(CreateFrameRef<MouseScrolledEvent>(frameAllocator, 0.0f, 1.0f));
+            eventQueue.push_back(CreateFrameRef<KeyPressedEvent>(frameAllocator, (KeyCode)65, false));
+        }
+
+        void processEvents() {
+            for (size_t i = 0; i < eventQueue.size(); i++) {
+                Ref<Event> e = eventQueue[i];
+                EventDispatcher dispatcher(*e);
+                dispatcher.dispatch<MouseMovedEvent>([this](MouseMovedEvent&) { handled++; return true; });
+                dispatcher.dispatch<KeyPressedEvent>([this](KeyPressedEvent&) { handled++; return true; });
+            }
+            eventQueue.clear();
+        }
+
+        void renderImGui() {
+            ImGui::NewFrame();
+            ImGui::Begin("Steady state");
+            ImGui::Text("frame %u, handled %u", frame, handled);
+            ImGui::Button("Button");
+            values[frame % 64] = (float)(frame % 17);
+            ImGui::PlotLines("values", values, 64);
+            if (ImGui::BeginTable("table", 3)) {
+                for (int row = 0; row < 8; row++) {
+                    ImGui::TableNextRow();
+                    for (int column = 0; column < 3; column++) {
+                        ImGui::TableSetColumnIndex(column);
+                        ImGui::Text("%d:%d", row, column);
+                    }
+                }
+                ImGui::EndTable();
+            }
+            ImGui::End();
+            ImGui::Render();
+        }
+
+        void step() {
+            queueInput();
+            processEvents();
+            renderImGui();
+            frameAllocator.endFrame();
+            AllocationTracker::endFrame();
+            frame++;
+        }
+    };
+
+}
+
+int main() {
+    if (!AllocationTracker::isEnabled()) {
+        std::println("steady state allocations: built without VICA_TRACK_ALLOCATIONS");
+        return 1;
+    }
+
+    ImGui::SetAllocatorFunctions(
+        [](size_t size, void*) { VICA_ALLOC_SCOPE(AllocationTag::ImGui); return ::operator new(size); },
+        [](void* ptr, void*) { ::operator delete(ptr); });
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+    io.DisplaySize = ImVec2(1280.0f, 720.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    HeadlessFrame frame;
+    for (uint32_t i = 0; i < WarmupFrames; i++)
+        frame.step();
+
+    uint64_t worstFrame = 0, total = 0;
+    for (uint32_t i = 0; i < MeasuredFrames; i++) {
+        uint64_t before = AllocationTracker::getThreadAllocationCount();
+        frame.step();
+        uint64_t count = AllocationTracker::getThreadAllocationCount() - before;
+        total += count;
+        worstFrame = std::max(worstFrame, count);
+    }
+
+    ImGui::DestroyContext();
+
+    std::println("steady state allocations: {} over {} frames (worst frame {})", total, MeasuredFrames, worstFrame);
+    return total == 0 ? 0 : 1;
+}